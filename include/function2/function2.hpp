@@ -7,10 +7,13 @@
 #ifndef FU2_INCLUDED_FUNCTION2_HPP_
 #define FU2_INCLUDED_FUNCTION2_HPP_
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <new>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -63,6 +66,32 @@
 #endif
 #endif // FU2_WITH_CXX17_NOEXCEPT_FUNCTION_TYPE
 
+// - FU2_HAS_CXX17_IN_PLACE_TYPE
+#if defined(FU2_WITH_CXX17_IN_PLACE_TYPE)
+#define FU2_HAS_CXX17_IN_PLACE_TYPE
+#else // FU2_WITH_CXX17_IN_PLACE_TYPE
+#if defined(_MSC_VER)
+#if defined(_HAS_CXX17) && _HAS_CXX17
+#define FU2_HAS_CXX17_IN_PLACE_TYPE
+#endif
+#elif defined(__cplusplus) && (__cplusplus >= 201703L)
+#define FU2_HAS_CXX17_IN_PLACE_TYPE
+#endif
+#endif // FU2_WITH_CXX17_IN_PLACE_TYPE
+
+// - FU2_HAS_CXX17_AUTO_TEMPLATE_PARAMETER
+#if defined(FU2_WITH_CXX17_AUTO_TEMPLATE_PARAMETER)
+#define FU2_HAS_CXX17_AUTO_TEMPLATE_PARAMETER
+#else // FU2_WITH_CXX17_AUTO_TEMPLATE_PARAMETER
+#if defined(_MSC_VER)
+#if defined(_HAS_CXX17) && _HAS_CXX17
+#define FU2_HAS_CXX17_AUTO_TEMPLATE_PARAMETER
+#endif
+#elif defined(__cpp_nontype_template_parameter_auto)
+#define FU2_HAS_CXX17_AUTO_TEMPLATE_PARAMETER
+#endif
+#endif // FU2_WITH_CXX17_AUTO_TEMPLATE_PARAMETER
+
 // - FU2_HAS_NO_EMPTY_PROPAGATION
 #if defined(FU2_WITH_NO_EMPTY_PROPAGATION)
 #define FU2_HAS_NO_EMPTY_PROPAGATION
@@ -139,6 +168,20 @@ class function;
 template <typename...>
 struct identity {};
 
+#ifdef FU2_HAS_CXX17_IN_PLACE_TYPE
+using std::in_place_type;
+using std::in_place_type_t;
+#else
+/// Equivalent to C++17's std::in_place_type_t
+template <typename T>
+struct in_place_type_t {
+  explicit in_place_type_t() = default;
+};
+/// Equivalent to C++17's std::in_place_type
+template <typename T>
+constexpr in_place_type_t<T> in_place_type{};
+#endif
+
 // Equivalent to C++17's std::void_t which targets a bug in GCC,
 // that prevents correct SFINAE behavior.
 // See http://stackoverflow.com/questions/35753920 for details.
@@ -177,6 +220,95 @@ struct copyable<false> {
   copyable& operator=(copyable&&) = default;
 };
 
+/// Describes how the command and the invocation table are stored
+enum class table_layout {
+  split,   ///< A pointer to each table is stored inside the function
+  merged,  ///< A single pointer to a merged static table is stored
+  inlined, ///< The invokers itself are stored inside the function
+  thin,    ///< Only a pointer to a heap block which holds the table is stored
+};
+
+/// Describes which objects are allocated inplace when they fit
+enum class inplace_rule {
+  any,                  ///< All objects are allocated inplace
+  nothrow_movable,      ///< Only nothrow move constructible objects
+  trivially_relocatable ///< Only objects which are relocated bitwise
+};
+
+/// Describes whether heap allocated objects are shared between copies
+enum class sharing_rule {
+  none,       ///< Every copy allocates its own object
+  non_atomic, ///< Copies share the object through a plain reference count
+  atomic      ///< Copies share the object through an atomic reference count
+};
+
+/// Deduces to a true type if the given capacity requests the command and
+/// the invocation table to be merged into a single static table.
+template <typename Capacity, typename = void>
+struct is_merged_capacity : std::false_type {};
+template <typename Capacity>
+struct is_merged_capacity<Capacity, void_t<decltype(Capacity::is_merged)>>
+    : std::integral_constant<bool, Capacity::is_merged> {};
+
+/// Deduces to a true type if the given capacity requests only objects which
+/// are nothrow move constructible to be allocated inplace.
+template <typename Capacity, typename = void>
+struct is_nothrow_movable_capacity : std::false_type {};
+template <typename Capacity>
+struct is_nothrow_movable_capacity<
+    Capacity, void_t<decltype(Capacity::is_nothrow_movable)>>
+    : std::integral_constant<bool, Capacity::is_nothrow_movable> {};
+
+/// Deduces to a true type if the given capacity requests only objects which
+/// are relocated bitwise to be allocated inplace.
+template <typename Capacity, typename = void>
+struct is_trivially_relocatable_capacity : std::false_type {};
+template <typename Capacity>
+struct is_trivially_relocatable_capacity<
+    Capacity, void_t<decltype(Capacity::is_trivially_relocatable)>>
+    : std::integral_constant<bool, Capacity::is_trivially_relocatable> {};
+
+/// Deduces to a true type if the given capacity requests the invokers
+/// to be stored inside the function object.
+template <typename Capacity, typename = void>
+struct is_inlined_capacity : std::false_type {};
+template <typename Capacity>
+struct is_inlined_capacity<Capacity, void_t<decltype(Capacity::is_inlined)>>
+    : std::integral_constant<bool, Capacity::is_inlined> {};
+
+/// Deduces to a true type if the given capacity requests the function to
+/// store a single pointer to a heap block, which holds the table in front
+/// of the object.
+template <typename Capacity, typename = void>
+struct is_thin_capacity : std::false_type {};
+template <typename Capacity>
+struct is_thin_capacity<Capacity, void_t<decltype(Capacity::is_thin)>>
+    : std::integral_constant<bool, Capacity::is_thin> {};
+
+/// Deduces to a true type if the given capacity requests all objects to be
+/// allocated inplace, which turns objects that don't fit into an error.
+template <typename Capacity, typename = void>
+struct is_strict_capacity : std::false_type {};
+template <typename Capacity>
+struct is_strict_capacity<Capacity, void_t<decltype(Capacity::is_strict)>>
+    : std::integral_constant<bool, Capacity::is_strict> {};
+
+/// Deduces to a true type if the given capacity requests heap allocated
+/// objects to be shared between copies of the function.
+template <typename Capacity, typename = void>
+struct is_shared_capacity : std::false_type {};
+template <typename Capacity>
+struct is_shared_capacity<Capacity, void_t<decltype(Capacity::is_shared)>>
+    : std::integral_constant<bool, Capacity::is_shared> {};
+
+/// Deduces to a false type if the given capacity requests the reference
+/// count of shared objects to be modified without atomic operations.
+template <typename Capacity, typename = void>
+struct is_atomic_capacity : std::true_type {};
+template <typename Capacity>
+struct is_atomic_capacity<Capacity, void_t<decltype(Capacity::is_atomic)>>
+    : std::integral_constant<bool, Capacity::is_atomic> {};
+
 /// Configuration trait to configure the function_base class.
 template <bool Owning, bool Copyable, typename Capacity>
 struct config {
@@ -191,6 +323,52 @@ struct config {
   // The object shall expose the real capacity through Capacity::capacity
   // and the intended alignment through Capacity::alignment.
   using capacity = Capacity;
+
+  // The layout of the command and the invocation table, which is requested
+  // through Capacity::is_merged, Capacity::is_inlined or Capacity::is_thin.
+  static constexpr auto const layout =
+      is_thin_capacity<Capacity>::value
+          ? table_layout::thin
+          : (is_merged_capacity<Capacity>::value
+                 ? table_layout::merged
+                 : (is_inlined_capacity<Capacity>::value
+                        ? table_layout::inlined
+                        : table_layout::split));
+
+  // The rule which objects are allocated inplace, which is requested
+  // through Capacity::is_nothrow_movable or
+  // Capacity::is_trivially_relocatable.
+  static constexpr auto const inplace =
+      is_trivially_relocatable_capacity<Capacity>::value
+          ? inplace_rule::trivially_relocatable
+          : (is_nothrow_movable_capacity<Capacity>::value
+                 ? inplace_rule::nothrow_movable
+                 : inplace_rule::any);
+
+  // Is true if the function is nothrow move constructible,
+  // since only nothrow move constructible objects are allocated inplace
+  // or all objects are allocated on the heap.
+  static constexpr auto const is_nothrow_movable =
+      (inplace != inplace_rule::any) || (layout == table_layout::thin);
+
+  // Is true if the function is relocated bitwise,
+  // since only such objects are allocated inplace
+  // or all objects are allocated on the heap.
+  static constexpr auto const is_trivially_relocatable =
+      (inplace == inplace_rule::trivially_relocatable) ||
+      (layout == table_layout::thin);
+
+  // The rule whether heap allocated objects are shared between copies,
+  // which is requested through Capacity::is_shared and Capacity::is_atomic.
+  static constexpr auto const sharing =
+      is_shared_capacity<Capacity>::value
+          ? (is_atomic_capacity<Capacity>::value ? sharing_rule::atomic
+                                                 : sharing_rule::non_atomic)
+          : sharing_rule::none;
+
+  // Is true if all objects have to be allocated inplace,
+  // which is requested through Capacity::is_strict.
+  static constexpr auto const is_strict = is_strict_capacity<Capacity>::value;
 };
 
 /// A config which isn't compatible to other configs
@@ -204,6 +382,11 @@ struct property {
       HasStrongExceptGuarantee;
 };
 
+/// Marks a signature whose callable can also be invoked with a whole
+/// range of arguments through a single call of its erased thunk
+template <typename Signature>
+struct batch {};
+
 #ifndef NDEBUG
 [[noreturn]] inline void unreachable_debug() {
   FU2_DETAIL_TRAP();
@@ -379,6 +562,10 @@ struct box : private Allocator {
   explicit box(T value, Allocator allocator_)
       : Allocator(std::move(allocator_)), value_(std::move(value)) {
   }
+  template <typename... Args>
+  explicit box(in_place_type_t<T>, Allocator allocator_, Args&&... args)
+      : Allocator(std::move(allocator_)), value_(std::forward<Args>(args)...) {
+  }
 
   box(box&&) = default;
   box(box const&) = default;
@@ -395,6 +582,10 @@ struct box<false, T, Allocator> : private Allocator {
   explicit box(T value, Allocator allocator_)
       : Allocator(std::move(allocator_)), value_(std::move(value)) {
   }
+  template <typename... Args>
+  explicit box(in_place_type_t<T>, Allocator allocator_, Args&&... args)
+      : Allocator(std::move(allocator_)), value_(std::forward<Args>(args)...) {
+  }
 
   box(box&&) = default;
   box(box const&) = delete;
@@ -408,16 +599,33 @@ struct box_factory<box<IsCopyable, T, Allocator>> {
   using real_allocator =
       typename std::allocator_traits<std::decay_t<Allocator>>::
           template rebind_alloc<box<IsCopyable, T, Allocator>>;
+  template <typename Block>
+  using block_allocator = typename std::allocator_traits<
+      std::decay_t<Allocator>>::template rebind_alloc<Block>;
 
   /// Allocates space through the boxed allocator
   static box<IsCopyable, T, Allocator>*
   box_allocate(box<IsCopyable, T, Allocator> const* me) {
-    real_allocator allocator_(*static_cast<Allocator const*>(me));
+    return box_allocate(*static_cast<Allocator const*>(me));
+  }
+
+  /// Allocates space through the given allocator
+  static box<IsCopyable, T, Allocator>*
+  box_allocate(Allocator const& allocator) {
+    real_allocator allocator_(allocator);
 
     return static_cast<box<IsCopyable, T, Allocator>*>(
         std::allocator_traits<real_allocator>::allocate(allocator_, 1U));
   }
 
+  /// Deallocates space which doesn't contain a constructed box
+  static void box_release(Allocator const& allocator,
+                          box<IsCopyable, T, Allocator>* me) noexcept {
+    real_allocator allocator_(allocator);
+
+    std::allocator_traits<real_allocator>::deallocate(allocator_, me, 1U);
+  }
+
   /// Destroys the box through the given allocator
   static void box_deallocate(box<IsCopyable, T, Allocator>* me) {
     real_allocator allocator_(*static_cast<Allocator const*>(me));
@@ -425,8 +633,143 @@ struct box_factory<box<IsCopyable, T, Allocator>> {
     me->~box();
     std::allocator_traits<real_allocator>::deallocate(allocator_, me, 1U);
   }
+
+  /// Allocates space for a block which derives from the box
+  /// through the boxed allocator
+  template <typename Block>
+  static Block* block_allocate(box<IsCopyable, T, Allocator> const* me) {
+    return block_allocate<Block>(*static_cast<Allocator const*>(me));
+  }
+
+  /// Allocates space for a block which derives from the box
+  /// through the given allocator
+  template <typename Block>
+  static Block* block_allocate(Allocator const& allocator) {
+    block_allocator<Block> allocator_(allocator);
+
+    return static_cast<Block*>(
+        std::allocator_traits<block_allocator<Block>>::allocate(allocator_,
+                                                                1U));
+  }
+
+  /// Deallocates space which doesn't contain a constructed block
+  template <typename Block>
+  static void block_release(Allocator const& allocator, Block* me) noexcept {
+    block_allocator<Block> allocator_(allocator);
+
+    std::allocator_traits<block_allocator<Block>>::deallocate(allocator_, me,
+                                                              1U);
+  }
+
+  /// Copies the block into new space allocated through its boxed allocator
+  template <typename Block>
+  static Block* block_copy(Block const* me) {
+    auto const& box_ = static_cast<box<IsCopyable, T, Allocator> const&>(*me);
+    auto const& allocator = *static_cast<Allocator const*>(&box_);
+
+    Block* block = block_allocate<Block>(allocator);
+#if !defined(FU2_HAS_DISABLED_EXCEPTIONS)
+    try {
+      new (block) Block(box_);
+    } catch (...) {
+      block_release(allocator, block);
+      throw;
+    }
+#else
+    new (block) Block(box_);
+#endif
+    return block;
+  }
+
+  /// Destroys the block through the boxed allocator
+  template <typename Block>
+  static void block_deallocate(Block* me) {
+    auto const& box_ = static_cast<box<IsCopyable, T, Allocator> const&>(*me);
+    block_allocator<Block> allocator_(*static_cast<Allocator const*>(&box_));
+
+    me->~Block();
+    std::allocator_traits<block_allocator<Block>>::deallocate(allocator_, me,
+                                                              1U);
+  }
+};
+
+/// Counts the references to a shared heap block
+template <bool IsAtomic>
+class shared_counter {
+  std::atomic<std::size_t> count_{1U};
+
+public:
+  void acquire() noexcept {
+    count_.fetch_add(1U, std::memory_order_relaxed);
+  }
+  /// Returns true when the last reference was released
+  bool release() noexcept {
+    return count_.fetch_sub(1U, std::memory_order_acq_rel) == 1U;
+  }
+  bool is_unique() const noexcept {
+    return count_.load(std::memory_order_acquire) == 1U;
+  }
+};
+template <>
+class shared_counter<false> {
+  std::size_t count_{1U};
+
+public:
+  void acquire() noexcept {
+    ++count_;
+  }
+  /// Returns true when the last reference was released
+  bool release() noexcept {
+    return --count_ == 0U;
+  }
+  bool is_unique() const noexcept {
+    return count_ == 1U;
+  }
+};
+
+/// A heap block which is shared between copies of a function,
+/// the pointer stored inside the function refers to the box.
+template <typename Box, typename Counter>
+struct shared_block : Box {
+  Counter counter_;
+
+  template <typename... Args>
+  explicit shared_block(Args&&... args) : Box(std::forward<Args>(args)...) {
+  }
 };
 
+/// The header of a heap block acquired through reserve, which is placed
+/// in front of the storage handed out for erased objects.
+struct alignas(std::max_align_t) reserved_header {
+  std::size_t size_;
+};
+
+/// Allocates a heap block which provides the given size to erased objects
+inline void* reserved_allocate(std::size_t size) {
+  auto header = static_cast<reserved_header*>(
+      ::operator new(sizeof(reserved_header) + size));
+  header->size_ = size;
+  return header + 1;
+}
+
+/// Deallocates a heap block returned by reserved_allocate
+inline void reserved_deallocate(void* ptr) noexcept {
+  ::operator delete(static_cast<reserved_header*>(ptr) - 1);
+}
+
+/// Returns the size of a heap block returned by reserved_allocate
+inline std::size_t reserved_size(void const* ptr) noexcept {
+  return (static_cast<reserved_header const*>(ptr) - 1)->size_;
+}
+
+/// Returns true when the heap block returned by reserved_allocate
+/// can hold an object of type T.
+template <typename T>
+bool reserved_can_hold(void const* ptr) noexcept {
+  return (sizeof(T) <= reserved_size(ptr)) &&
+         (alignof(T) <= alignof(reserved_header));
+}
+
 /// Creates a box containing the given value and allocator
 template <bool IsCopyable, typename T, typename Allocator>
 auto make_box(std::integral_constant<bool, IsCopyable>, T&& value,
@@ -435,11 +778,117 @@ auto make_box(std::integral_constant<bool, IsCopyable>, T&& value,
       std::forward<T>(value), std::forward<Allocator>(allocator_));
 }
 
+/// Deduces to a true type if the callable doesn't carry any state,
+/// like captureless lambdas, and thus never requires any storage.
+///
+/// Closures are never assigned, therefore only their construction
+/// and destruction is required to be trivial.
+template <typename T>
+struct is_stateless_callable
+    : std::integral_constant<
+          bool, std::is_empty<T>::value &&
+                    std::is_trivially_copy_constructible<T>::value &&
+                    std::is_trivially_move_constructible<T>::value &&
+                    std::is_trivially_destructible<T>::value &&
+                    (alignof(T) <= alignof(void*))> {};
+
+template <bool IsCopyable, typename T, typename Allocator>
+auto make_erased_box(std::false_type /*is_stateless*/,
+                     std::integral_constant<bool, IsCopyable> is_copyable,
+                     T&& value, Allocator&& allocator_) {
+  return make_box(is_copyable, std::forward<T>(value),
+                  std::forward<Allocator>(allocator_));
+}
+template <bool IsCopyable, typename T, typename Allocator>
+auto make_erased_box(std::true_type /*is_stateless*/,
+                     std::integral_constant<bool, IsCopyable> is_copyable,
+                     T&& value, Allocator&& /*allocator_*/) {
+  return make_box(is_copyable, std::forward<T>(value),
+                  std::allocator<std::decay_t<T>>{});
+}
+
+/// Creates a box containing the given value and allocator which is stored
+/// inside an erasure, the allocator of a stateless callable is dropped
+/// since such a callable is always stored inplace.
+template <bool IsCopyable, typename T, typename Allocator>
+auto make_erased_box(std::integral_constant<bool, IsCopyable> is_copyable,
+                     T&& value, Allocator&& allocator_) {
+  return make_erased_box(is_stateless_callable<std::decay_t<T>>{},
+                         is_copyable, std::forward<T>(value),
+                         std::forward<Allocator>(allocator_));
+}
+
 template <typename T>
 struct is_box : std::false_type {};
 template <bool IsCopyable, typename T, typename Allocator>
 struct is_box<box<IsCopyable, T, Allocator>> : std::true_type {};
 
+/// Deduces to a true type if the allocator doesn't carry any state
+/// which needs to be copied or destroyed.
+template <typename Allocator>
+struct is_stateless_allocator
+    : std::integral_constant<bool,
+                             std::is_empty<Allocator>::value &&
+                                 std::is_trivially_copyable<Allocator>::value> {
+};
+template <typename T>
+struct is_stateless_allocator<std::allocator<T>> : std::true_type {};
+
+/// Deduces to a true type if the memory of the box may be released through
+/// any other instance of its allocator.
+template <typename T>
+struct is_stateless_allocator_box : std::false_type {};
+template <bool IsCopyable, typename T, typename Allocator>
+struct is_stateless_allocator_box<box<IsCopyable, T, Allocator>>
+    : std::allocator_traits<Allocator>::is_always_equal {};
+
+/// Deduces to a true type if the box can be copied bitwise
+template <typename T>
+struct is_trivially_copyable_box : std::false_type {};
+template <bool IsCopyable, typename T, typename Allocator>
+struct is_trivially_copyable_box<box<IsCopyable, T, Allocator>>
+    : std::integral_constant<bool,
+                             std::is_trivially_copyable<T>::value &&
+                                 is_stateless_allocator<Allocator>::value> {};
+
+/// Deduces to a true type if the box doesn't require any destruction
+template <typename T>
+struct is_trivially_destructible_box : std::false_type {};
+template <bool IsCopyable, typename T, typename Allocator>
+struct is_trivially_destructible_box<box<IsCopyable, T, Allocator>>
+    : std::integral_constant<bool,
+                             std::is_trivially_destructible<T>::value &&
+                                 is_stateless_allocator<Allocator>::value> {};
+
+/// Deduces to a true type if neither the callable nor the allocator of the
+/// box carry any state, which means that the box is always stored inplace
+/// and is moved or copied without touching its storage.
+template <typename T>
+struct is_stateless_box : std::false_type {};
+template <bool IsCopyable, typename T, typename Allocator>
+struct is_stateless_box<box<IsCopyable, T, Allocator>>
+    : std::integral_constant<bool,
+                             is_stateless_callable<T>::value &&
+                                 is_stateless_allocator<Allocator>::value> {};
+
+/// Deduces to the box which identifies the erased object of the box T.
+///
+/// A box with an empty allocator only holds the callable, therefore
+/// it is identified through the box of the callable with the default
+/// allocator, which makes the type check independent of the allocator.
+template <typename T>
+struct box_identity {
+  using type = T;
+};
+template <bool IsCopyable, typename T, typename Allocator>
+struct box_identity<box<IsCopyable, T, Allocator>> {
+  using type = std::conditional_t<std::is_empty<Allocator>::value,
+                                  box<IsCopyable, T, std::allocator<T>>,
+                                  box<IsCopyable, T, Allocator>>;
+};
+template <typename T>
+using box_identity_t = typename box_identity<T>::type;
+
 /// Provides access to the pointer to a heal allocated erased object
 /// as well to the inplace storage.
 union data_accessor {
@@ -465,12 +914,6 @@ union data_accessor {
   std::size_t inplace_storage_;
 };
 
-/// See opcode::op_fetch_empty
-static FU2_DETAIL_CXX14_CONSTEXPR void write_empty(data_accessor* accessor,
-                                                   bool empty) noexcept {
-  accessor->inplace_storage_ = std::size_t(empty);
-}
-
 template <typename From, typename To>
 using transfer_const_t =
     std::conditional_t<std::is_const<std::remove_pointer_t<From>>::value,
@@ -480,27 +923,130 @@ using transfer_volatile_t =
     std::conditional_t<std::is_volatile<std::remove_pointer_t<From>>::value,
                        std::add_volatile_t<To>, To>;
 
+/// Returns the storage inside the internal capacity where an object of
+/// type T is constructed inplace, or a nullptr if the object doesn't fit.
+///
+/// Objects are always placed at the beginning of the internal capacity,
+/// so their address never needs to be recomputed on invocation.
+/// Over aligned objects are only stored inplace if the capacity
+/// is aligned accordingly through Capacity::alignment, which only depends
+/// on the type of the function and never on the address of the storage.
+template <typename T>
+void* inplace_storage_of(data_accessor* to, std::size_t to_capacity,
+                         std::size_t to_alignment) noexcept {
+  if ((sizeof(T) > to_capacity) || (alignof(T) > to_alignment)) {
+    return nullptr;
+  }
+  return &(to->inplace_storage_);
+}
+
 /// The retriever when the object is allocated inplace
 template <typename T, typename Accessor>
-FU2_DETAIL_CXX14_CONSTEXPR auto retrieve(std::true_type /*is_inplace*/,
-                                         Accessor from,
-                                         std::size_t from_capacity) {
+constexpr auto retrieve(std::true_type /*is_inplace*/, Accessor from) {
   using type = transfer_const_t<Accessor, transfer_volatile_t<Accessor, void>>*;
 
   /// Process the command by using the data inside the internal capacity
-  auto storage = &(from->inplace_storage_);
-  auto inplace = const_cast<void*>(static_cast<type>(storage));
-  return type(std::align(alignof(T), sizeof(T), inplace, from_capacity));
+  return static_cast<type>(&(from->inplace_storage_));
 }
 
 /// The retriever which is used when the object is allocated
 /// through the allocator
 template <typename T, typename Accessor>
-constexpr auto retrieve(std::false_type /*is_inplace*/, Accessor from,
-                        std::size_t /*from_capacity*/) {
+constexpr auto retrieve(std::false_type /*is_inplace*/, Accessor from) {
+
+  return from->ptr_;
+}
+
+/// Marks objects which are allocated inside a shared heap block
+template <typename Counter>
+struct shared_placement {};
+
+/// Returns the shared box referenced by the given accessor
+template <typename T, typename Counter, typename Accessor>
+shared_block<T, Counter>* shared_block_of(Accessor from) noexcept {
+  return static_cast<shared_block<T, Counter>*>(static_cast<T*>(from->ptr_));
+}
+
+/// Copies the shared box referenced by the given accessor into a block
+/// which is owned by the accessor alone, if it is referenced elsewhere too.
+template <typename T, typename Counter, typename Accessor>
+void* unshare(std::true_type /*is_copyable*/, Accessor from) {
+  using block_t = shared_block<T, Counter>;
+
+  block_t* block = shared_block_of<T, Counter>(from);
+  if (!block->counter_.is_unique()) {
+    block_t* copy = box_factory<T>::block_copy(block);
+    if (block->counter_.release()) {
+      // All other references were released in between
+      box_factory<T>::block_deallocate(block);
+    }
+    from->ptr_ = static_cast<T*>(copy);
+  }
+  return from->ptr_;
+}
+template <typename T, typename Counter, typename Accessor>
+void* unshare(std::false_type /*is_copyable*/, Accessor from) {
+  // Boxes which aren't copyable are never shared
+  return from->ptr_;
+}
 
+/// The retriever which is used when the shared object is accessed through
+/// a const qualified signature, which never requires a copy.
+template <typename T, typename Counter>
+constexpr void* retrieve(shared_placement<Counter> /*is_shared*/,
+                         data_accessor const* from) {
   return from->ptr_;
 }
+template <typename T, typename Counter>
+constexpr void* retrieve(shared_placement<Counter> /*is_shared*/,
+                         data_accessor const volatile* from) {
+  return from->ptr_;
+}
+
+/// The retriever which is used when the shared object is accessed through
+/// a mutable signature, which copies the object before (copy on write).
+template <typename T, typename Counter>
+void* retrieve(shared_placement<Counter> /*is_shared*/, data_accessor* from) {
+  return unshare<T, Counter>(std::is_copy_constructible<T>{}, from);
+}
+template <typename T, typename Counter>
+void* retrieve(shared_placement<Counter> /*is_shared*/,
+               data_accessor volatile* from) {
+  return unshare<T, Counter>(std::is_copy_constructible<T>{}, from);
+}
+
+/// Marks objects which are allocated inside a heap block of the given type,
+/// which is referenced by a thin function.
+template <typename Block>
+struct thin_placement {};
+
+/// The retriever which is used when the object is allocated inside
+/// a thin heap block
+template <typename T, typename Block, typename Accessor>
+T* retrieve(thin_placement<Block> /*is_thin*/, Accessor from) noexcept {
+  return Block::of(from->ptr_);
+}
+
+/// Provides a constant initialized instance of the given table type,
+/// which never requires a guarded or dynamic initialization.
+template <typename Table>
+struct static_table {
+  static constexpr Table const value{};
+};
+template <typename Table>
+constexpr Table const static_table<Table>::value;
+
+/// Provides an unique address for the given types, which identifies the type
+/// and placement of an erased object without requiring RTTI.
+///
+/// The address belongs to a mutable object, so the linker never folds it
+/// together with the address of another type.
+template <typename... T>
+struct type_id {
+  static char id;
+};
+template <typename... T>
+char type_id<T...>::id = 0;
 
 namespace invocation_table {
 #if !defined(FU2_HAS_DISABLED_EXCEPTIONS)
@@ -589,30 +1135,74 @@ struct function_trait;
 using is_noexcept_ = std::false_type;
 using is_noexcept_noexcept = std::true_type;
 
+/// Deduces to a true type if the argument fits into two registers and
+/// can be copied bitwise, which is false for incomplete types.
+template <typename T, typename = void>
+struct is_register_sized_trivial : std::false_type {};
+template <typename T>
+struct is_register_sized_trivial<T, std::enable_if_t<(sizeof(T) > 0)>>
+    : std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                       (sizeof(T) <= 2 * sizeof(void*))> {};
+
+/// Deduces to the type through which an argument is passed to a thunk.
+///
+/// References and register sized trivial types are passed unchanged
+/// while all other arguments are passed by reference, so arguments which
+/// are taken by value are only moved once from the call operator
+/// into the callable.
+template <typename T>
+using thunk_arg_t =
+    std::conditional_t<std::is_scalar<T>::value ||
+                           std::is_reference<T>::value ||
+                           is_register_sized_trivial<T>::value,
+                       T, T&&>;
+
+/// Returns the opaque context which is passed to the thunks, which restore
+/// the qualifiers of the data_accessor from their signature.
+template <typename Accessor>
+constexpr void* context_of(Accessor* from) noexcept {
+  return const_cast<void*>(static_cast<void const volatile*>(from));
+}
+
+/// Thunks receive the data_accessor of the function as opaque context,
+/// which makes them usable as plain callbacks of C interfaces.
 #define FU2_DEFINE_FUNCTION_TRAIT(CONST, VOLATILE, NOEXCEPT, OVL_REF, REF)     \
   template <typename Ret, typename... Args>                                    \
   struct function_trait<Ret(Args...) CONST VOLATILE OVL_REF NOEXCEPT> {        \
-    using pointer_type = Ret (*)(data_accessor CONST VOLATILE*,                \
-                                 std::size_t capacity, Args...);               \
-    template <typename T, bool IsInplace>                                      \
+    using pointer_type = Ret (*)(void*, thunk_arg_t<Args>...);                 \
+    using direct_pointer_type = Ret (*)(Args...) NOEXCEPT;                     \
+    template <typename T, typename Placement>                                  \
     struct internal_invoker {                                                  \
-      static Ret invoke(data_accessor CONST VOLATILE* data,                    \
-                        std::size_t capacity, Args... args) NOEXCEPT {         \
-        auto obj = retrieve<T>(std::integral_constant<bool, IsInplace>{},      \
-                               data, capacity);                                \
+      static Ret invoke(void* context, thunk_arg_t<Args>... args) NOEXCEPT {   \
+        auto data = static_cast<data_accessor CONST VOLATILE*>(context);       \
+        auto obj = retrieve<T>(Placement{}, data);                             \
         auto box = static_cast<T CONST VOLATILE*>(obj);                        \
         return invocation::invoke(                                             \
             static_cast<std::decay_t<decltype(box->value_)> CONST VOLATILE     \
                             REF>(box->value_),                                 \
             std::forward<Args>(args)...);                                      \
       }                                                                        \
+    };                                                                         \
+    /* Plain function pointers stored inplace get their own thunk, which  */   \
+    /* loads the pointer without any qualifier and tail calls it, so the  */   \
+    /* invocation still takes two indirect branches.                      */   \
+    template <bool IsCopyable, typename Allocator>                             \
+    struct internal_invoker<box<IsCopyable, direct_pointer_type, Allocator>,   \
+                            std::true_type> {                                  \
+      using box_t = box<IsCopyable, direct_pointer_type, Allocator>;           \
+                                                                               \
+      static Ret invoke(void* context, thunk_arg_t<Args>... args) NOEXCEPT {   \
+        auto data = static_cast<data_accessor const*>(context);                \
+        auto obj = retrieve<box_t>(std::true_type{}, data);                    \
+        return static_cast<box_t const*>(obj)->value_(                         \
+            std::forward<Args>(args)...);                                      \
+      }                                                                        \
     };                                                                         \
                                                                                \
     template <typename T>                                                      \
     struct view_invoker {                                                      \
-      static Ret invoke(data_accessor CONST VOLATILE* data, std::size_t,       \
-                        Args... args) NOEXCEPT {                               \
-                                                                               \
+      static Ret invoke(void* context, thunk_arg_t<Args>... args) NOEXCEPT {   \
+        auto data = static_cast<data_accessor CONST VOLATILE*>(context);       \
         auto ptr = static_cast<void CONST VOLATILE*>(data->ptr_);              \
         return invocation::invoke(address_taker<T>::restore(ptr),              \
                                   std::forward<Args>(args)...);                \
@@ -628,8 +1218,8 @@ using is_noexcept_noexcept = std::true_type;
                                                                                \
     template <bool Throws>                                                     \
     struct empty_invoker {                                                     \
-      static Ret invoke(data_accessor CONST VOLATILE* /*data*/,                \
-                        std::size_t /*capacity*/, Args... /*args*/) NOEXCEPT { \
+      static Ret invoke(void* /*context*/,                                     \
+                        thunk_arg_t<Args>... /*args*/) NOEXCEPT {              \
         throw_or_abort##NOEXCEPT(std::integral_constant<bool, Throws>{});      \
       }                                                                        \
     };                                                                         \
@@ -638,83 +1228,369 @@ using is_noexcept_noexcept = std::true_type;
 FU2_DETAIL_EXPAND_QUALIFIERS(FU2_DEFINE_FUNCTION_TRAIT)
 #undef FU2_DEFINE_FUNCTION_TRAIT
 
-/// Deduces to the function pointer to the given signature
-template <typename Signature>
-using function_pointer_of = typename function_trait<Signature>::pointer_type;
-
-template <typename... Args>
-struct invoke_table;
-
-/// We optimize the vtable_t in case there is a single function overload
-template <typename First>
-struct invoke_table<First> {
-  using type = function_pointer_of<First>;
-
-  /// Return the function pointer itself
-  template <std::size_t Index>
-  static constexpr auto fetch(type pointer) noexcept {
-    static_assert(Index == 0U, "The index should be 0 here!");
-    return pointer;
-  }
-
-  /// Returns the thunk of an single overloaded callable
-  template <typename T, bool IsInplace>
-  static constexpr type get_invocation_table_of() noexcept {
-    return &function_trait<First>::template internal_invoker<T,
-                                                             IsInplace>::invoke;
+/// Invokes a callable once for every element of a batch, where every
+/// element holds the arguments of a single call. Elements of signatures
+/// with a single argument are the decayed argument itself, otherwise
+/// the element is a tuple of all decayed arguments.
+template <typename Ret, typename... Args>
+struct batch_loop {
+  using element_type = std::tuple<std::decay_t<Args>...>;
+
+  template <typename Callable, std::size_t... I>
+  static decltype(auto) call(Callable&& callable, element_type const& element,
+                             std::index_sequence<I...>) {
+    return invocation::invoke(std::forward<Callable>(callable),
+                              std::get<I>(element)...);
   }
-  /// Returns the thunk of an single overloaded callable
-  template <typename T>
-  static constexpr type get_invocation_view_table_of() noexcept {
-    return &function_trait<First>::template view_invoker<T>::invoke;
+  template <typename Callable>
+  static decltype(auto) call(Callable&& callable,
+                             element_type const& element) {
+    return call(std::forward<Callable>(callable), element,
+                std::index_sequence_for<Args...>{});
   }
-  /// Returns the thunk of an empty single overloaded callable
-  template <bool IsThrowing>
-  static constexpr type get_empty_invocation_table() noexcept {
-    return &function_trait<First>::template empty_invoker<IsThrowing>::invoke;
+};
+template <typename Ret, typename Arg>
+struct batch_loop<Ret, Arg> {
+  using element_type = std::decay_t<Arg>;
+
+  template <typename Callable>
+  static decltype(auto) call(Callable&& callable,
+                             element_type const& element) {
+    return invocation::invoke(std::forward<Callable>(callable), element);
   }
 };
-/// We generate a table in case of multiple function overloads
-template <typename First, typename Second, typename... Args>
-struct invoke_table<First, Second, Args...> {
-  using type =
-      std::tuple<function_pointer_of<First>, function_pointer_of<Second>,
-                 function_pointer_of<Args>...> const*;
 
-  /// Return the function pointer at the particular index
-  template <std::size_t Index>
-  static constexpr auto fetch(type table) noexcept {
-    return std::get<Index>(*table);
+/// Applies the loop of a batch signature and stores the results of the
+/// callable into the output when the signature doesn't return void
+template <typename Ret, typename... Args>
+struct batch_invoker {
+  using loop_t = batch_loop<Ret, Args...>;
+  using element_type = typename loop_t::element_type;
+
+  static_assert(
+      std::is_same<std::integer_sequence<
+                       bool, true,
+                       std::is_convertible<std::decay_t<Args> const&,
+                                           Args>::value...>,
+                   std::integer_sequence<
+                       bool,
+                       std::is_convertible<std::decay_t<Args> const&,
+                                           Args>::value...,
+                       true>>::value,
+      "The arguments of a batch signature are passed from an immutable "
+      "range and thus can't be mutable references!");
+
+  template <typename Callable>
+  static void apply(Callable& callable, element_type const* first,
+                    std::size_t count, Ret* out) {
+    apply(std::is_void<Ret>{}, callable, first, count, out);
   }
 
-  /// The invocation vtable for a present object
-  template <typename T, bool IsInplace>
-  struct invocation_vtable : public std::tuple<function_pointer_of<First>,
-                                               function_pointer_of<Second>,
-                                               function_pointer_of<Args>...> {
-    constexpr invocation_vtable() noexcept
-        : std::tuple<function_pointer_of<First>, function_pointer_of<Second>,
-                     function_pointer_of<Args>...>(std::make_tuple(
-              &function_trait<First>::template internal_invoker<
-                  T, IsInplace>::invoke,
-              &function_trait<Second>::template internal_invoker<
-                  T, IsInplace>::invoke,
-              &function_trait<Args>::template internal_invoker<
-                  T, IsInplace>::invoke...)) {
+private:
+  template <typename Callable>
+  static void apply(std::true_type /*is_void*/, Callable& callable,
+                    element_type const* first, std::size_t count,
+                    Ret* /*out*/) {
+    for (std::size_t i = 0U; i != count; ++i) {
+      loop_t::call(callable, first[i]);
+    }
+  }
+  template <typename Callable>
+  static void apply(std::false_type /*is_void*/, Callable& callable,
+                    element_type const* first, std::size_t count, Ret* out) {
+    for (std::size_t i = 0U; i != count; ++i) {
+      out[i] = loop_t::call(callable, first[i]);
     }
-  };
-
-  /// Returns the thunk of an multi overloaded callable
-  template <typename T, bool IsInplace>
-  static type get_invocation_table_of() noexcept {
-    static invocation_vtable<T, IsInplace> const table;
-    return &table;
   }
+};
 
-  /// The invocation vtable for a present object
-  template <typename T>
-  struct invocation_view_vtable
-      : public std::tuple<function_pointer_of<First>,
+/// Batch signatures share the properties of their plain signature,
+/// but their thunks loop over a range of arguments.
+#define FU2_DEFINE_BATCH_TRAIT(CONST, VOLATILE, NOEXCEPT)                      \
+  template <typename Ret, typename... Args>                                    \
+  struct function_trait<batch<Ret(Args...) CONST VOLATILE NOEXCEPT>>           \
+      : function_trait<Ret(Args...) CONST VOLATILE NOEXCEPT> {                 \
+    using invoker_t = batch_invoker<Ret, Args...>;                             \
+    using element_type = typename invoker_t::element_type;                     \
+    using result_type = Ret;                                                   \
+    using is_const = std::is_const<int CONST>;                                 \
+    using pointer_type = void (*)(void*, element_type const*, std::size_t,     \
+                                  Ret*);                                       \
+                                                                               \
+    template <typename T, typename Placement>                                  \
+    struct internal_invoker {                                                  \
+      static void invoke(void* context, element_type const* first,             \
+                         std::size_t count, Ret* out) NOEXCEPT {               \
+        auto data = static_cast<data_accessor CONST VOLATILE*>(context);       \
+        auto obj = retrieve<T>(Placement{}, data);                             \
+        auto box = static_cast<T CONST VOLATILE*>(obj);                        \
+        invoker_t::apply(box->value_, first, count, out);                      \
+      }                                                                        \
+    };                                                                         \
+                                                                               \
+    template <typename T>                                                      \
+    struct view_invoker {                                                      \
+      static void invoke(void* context, element_type const* first,             \
+                         std::size_t count, Ret* out) NOEXCEPT {               \
+        auto data = static_cast<data_accessor CONST VOLATILE*>(context);       \
+        auto ptr = static_cast<void CONST VOLATILE*>(data->ptr_);              \
+        auto&& callable = address_taker<T>::restore(ptr);                      \
+        invoker_t::apply(callable, first, count, out);                         \
+      }                                                                        \
+    };                                                                         \
+                                                                               \
+    template <bool Throws>                                                     \
+    struct empty_invoker {                                                     \
+      static void invoke(void* /*context*/, element_type const* /*first*/,     \
+                         std::size_t /*count*/, Ret* /*out*/) NOEXCEPT {       \
+        throw_or_abort##NOEXCEPT(std::integral_constant<bool, Throws>{});      \
+      }                                                                        \
+    };                                                                         \
+  };
+
+FU2_DETAIL_EXPAND_CV(FU2_DEFINE_BATCH_TRAIT)
+#undef FU2_DEFINE_BATCH_TRAIT
+
+/// The index and the trait of a batch signature
+template <std::size_t Index, typename Signature>
+struct batch_index : std::integral_constant<std::size_t, Index> {
+  using trait = function_trait<Signature>;
+};
+
+/// Provides the index and the trait of the first batch signature which
+/// is invoked with elements of the given type
+template <typename Element, std::size_t Index, typename Signatures>
+struct batch_index_of {};
+template <typename Element, std::size_t Index, typename First,
+          typename... Rest>
+struct batch_index_of<Element, Index, identity<First, Rest...>>
+    : batch_index_of<Element, Index + 1U, identity<Rest...>> {};
+template <typename Element, std::size_t Index, typename Signature,
+          typename... Rest>
+struct batch_index_of<Element, Index, identity<batch<Signature>, Rest...>>
+    : std::conditional_t<
+          std::is_same<Element, typename function_trait<
+                                    batch<Signature>>::element_type>::value,
+          batch_index<Index, batch<Signature>>,
+          batch_index_of<Element, Index + 1U, identity<Rest...>>> {};
+
+/// Provides the index of the given signature
+template <typename Signature, std::size_t Index, typename Signatures>
+struct signature_index_of {};
+template <typename Signature, std::size_t Index, typename First,
+          typename... Rest>
+struct signature_index_of<Signature, Index, identity<First, Rest...>>
+    : signature_index_of<Signature, Index + 1U, identity<Rest...>> {};
+template <typename Signature, std::size_t Index, typename... Rest>
+struct signature_index_of<Signature, Index, identity<Signature, Rest...>>
+    : std::integral_constant<std::size_t, Index> {};
+
+/// A thunk together with the context which it is invoked with,
+/// where Arguments are the arguments of the call operator.
+template <typename Pointer, typename Arguments>
+struct raw_thunk;
+template <typename Ret, typename... ThunkArgs, typename... Args>
+struct raw_thunk<Ret (*)(void*, ThunkArgs...), identity<Args...>> {
+  /// The thunk which invokes the erased callable
+  Ret (*thunk)(void*, ThunkArgs...);
+  /// The context which is passed to the thunk as first argument
+  void* context;
+
+  /// Invokes the thunk with the context and the given arguments,
+  /// which are taken like the call operator of the function takes them.
+  Ret operator()(Args... args) const {
+    return thunk(context, std::forward<Args>(args)...);
+  }
+};
+
+/// Returns the offset of the argument at the given index inside a buffer
+/// where arguments of the given sizes are packed without padding
+template <std::size_t... Sizes>
+constexpr std::size_t packed_offset(std::size_t index) noexcept {
+  std::size_t const sizes[] = {Sizes..., 0U};
+  std::size_t offset = 0U;
+  for (std::size_t i = 0U; i != index; ++i) {
+    offset += sizes[i];
+  }
+  return offset;
+}
+
+/// A trivially copyable value which is loaded from an unaligned buffer
+template <typename T>
+struct packed_value {
+  std::aligned_storage_t<sizeof(T), alignof(T)> storage_;
+
+  explicit packed_value(unsigned char const* data) noexcept {
+    std::memcpy(&storage_, data, sizeof(T));
+  }
+
+  T& get() noexcept {
+    return *reinterpret_cast<T*>(&storage_);
+  }
+};
+
+/// Describes the buffer from which a signature is invoked, where the
+/// decayed arguments are stored in order of the signature in their
+/// native representation, without any padding or alignment in between.
+template <typename Arguments>
+struct packed_layout;
+template <typename... Args>
+struct packed_layout<identity<Args...>> {
+  static_assert(std::is_same<std::integer_sequence<
+                                 bool, true,
+                                 std::is_trivially_copyable<
+                                     std::decay_t<Args>>::value...>,
+                             std::integer_sequence<
+                                 bool,
+                                 std::is_trivially_copyable<
+                                     std::decay_t<Args>>::value...,
+                                 true>>::value,
+                "Only signatures with trivially copyable arguments can be "
+                "invoked from a buffer!");
+
+  /// The size of the buffer in bytes
+  static constexpr std::size_t size =
+      packed_offset<sizeof(std::decay_t<Args>)...>(sizeof...(Args));
+
+  /// Returns the offset of the argument at the given index in bytes
+  static constexpr std::size_t offset(std::size_t index) noexcept {
+    return packed_offset<sizeof(std::decay_t<Args>)...>(index);
+  }
+
+  /// Stores the given arguments into the buffer
+  static void store(void* data, std::decay_t<Args> const&... args) noexcept {
+    store(static_cast<unsigned char*>(data),
+          std::index_sequence_for<Args...>{}, args...);
+  }
+
+  /// Loads the arguments from the buffer and invokes the given callable
+  template <typename Callable>
+  static decltype(auto) load(void const* data, Callable&& callable) {
+    return load(static_cast<unsigned char const*>(data),
+                std::index_sequence_for<Args...>{},
+                std::forward<Callable>(callable));
+  }
+
+private:
+  template <std::size_t... I>
+  static void store(unsigned char* data, std::index_sequence<I...>,
+                    std::decay_t<Args> const&... args) noexcept {
+    int const stored[] = {
+        0, (std::memcpy(data + offset(I), std::addressof(args), sizeof(args)),
+            0)...};
+    (void)data;
+    (void)stored;
+  }
+
+  template <std::size_t... I, typename Callable>
+  static decltype(auto) load(unsigned char const* data,
+                             std::index_sequence<I...>, Callable&& callable) {
+    (void)data;
+    return apply(std::forward<Callable>(callable),
+                 packed_value<std::decay_t<Args>>(data + offset(I))...);
+  }
+
+  template <typename Callable, typename... Values>
+  static decltype(auto) apply(Callable&& callable, Values... values) {
+    return std::forward<Callable>(callable)(
+        std::forward<Args>(values.get())...);
+  }
+};
+
+/// Deduces to the function pointer to the given signature
+template <typename Signature>
+using function_pointer_of = typename function_trait<Signature>::pointer_type;
+
+/// Deduces to the arguments which the raw thunk of a signature is invoked
+/// with, which are the arguments of the thunk for batch signatures.
+template <typename Signature>
+struct raw_arguments_of {
+  using type = typename function_trait<Signature>::arguments;
+};
+template <typename Signature>
+struct raw_arguments_of<batch<Signature>> {
+  using trait_t = function_trait<batch<Signature>>;
+  using type = identity<typename trait_t::element_type const*, std::size_t,
+                        typename trait_t::result_type*>;
+};
+
+/// Deduces to the raw thunk of the given signature
+template <typename Signature>
+using raw_thunk_of = raw_thunk<function_pointer_of<Signature>,
+                               typename raw_arguments_of<Signature>::type>;
+
+template <typename... Args>
+struct invoke_table;
+
+/// We optimize the vtable_t in case there is a single function overload
+template <typename First>
+struct invoke_table<First> {
+  using type = function_pointer_of<First>;
+
+  /// Return the function pointer itself
+  template <std::size_t Index>
+  static constexpr auto fetch(type pointer) noexcept {
+    static_assert(Index == 0U, "The index should be 0 here!");
+    return pointer;
+  }
+
+  /// Returns the thunk of an single overloaded callable
+  template <typename T, typename Placement>
+  static constexpr type get_invocation_table_of() noexcept {
+    return &function_trait<First>::template internal_invoker<T,
+                                                             Placement>::invoke;
+  }
+  /// Returns the thunk of an single overloaded callable
+  template <typename T>
+  static constexpr type get_invocation_view_table_of() noexcept {
+    return &function_trait<First>::template view_invoker<T>::invoke;
+  }
+  /// Returns the thunk of an empty single overloaded callable
+  template <bool IsThrowing>
+  static constexpr type get_empty_invocation_table() noexcept {
+    return &function_trait<First>::template empty_invoker<IsThrowing>::invoke;
+  }
+};
+/// We generate a table in case of multiple function overloads
+template <typename First, typename Second, typename... Args>
+struct invoke_table<First, Second, Args...> {
+  using type =
+      std::tuple<function_pointer_of<First>, function_pointer_of<Second>,
+                 function_pointer_of<Args>...> const*;
+
+  /// Return the function pointer at the particular index
+  template <std::size_t Index>
+  static constexpr auto fetch(type table) noexcept {
+    return std::get<Index>(*table);
+  }
+
+  /// The invocation vtable for a present object
+  template <typename T, typename Placement>
+  struct invocation_vtable : public std::tuple<function_pointer_of<First>,
+                                               function_pointer_of<Second>,
+                                               function_pointer_of<Args>...> {
+    constexpr invocation_vtable() noexcept
+        : std::tuple<function_pointer_of<First>, function_pointer_of<Second>,
+                     function_pointer_of<Args>...>(std::make_tuple(
+              &function_trait<First>::template internal_invoker<
+                  T, Placement>::invoke,
+              &function_trait<Second>::template internal_invoker<
+                  T, Placement>::invoke,
+              &function_trait<Args>::template internal_invoker<
+                  T, Placement>::invoke...)) {
+    }
+  };
+
+  /// Returns the thunk of an multi overloaded callable
+  template <typename T, typename Placement>
+  static constexpr type get_invocation_table_of() noexcept {
+    return &static_table<invocation_vtable<T, Placement>>::value;
+  }
+
+  /// The invocation vtable for a present object
+  template <typename T>
+  struct invocation_view_vtable
+      : public std::tuple<function_pointer_of<First>,
                           function_pointer_of<Second>,
                           function_pointer_of<Args>...> {
     constexpr invocation_view_vtable() noexcept
@@ -728,9 +1604,8 @@ struct invoke_table<First, Second, Args...> {
 
   /// Returns the thunk of an multi overloaded callable
   template <typename T>
-  static type get_invocation_view_table_of() noexcept {
-    static invocation_view_vtable<T> const table;
-    return &table;
+  static constexpr type get_invocation_view_table_of() noexcept {
+    return &static_table<invocation_view_vtable<T>>::value;
   }
 
   /// The invocation table for an empty wrapper
@@ -752,9 +1627,8 @@ struct invoke_table<First, Second, Args...> {
 
   /// Returns the thunk of an multi single overloaded callable
   template <bool IsThrowing>
-  static type get_empty_invocation_table() noexcept {
-    static empty_vtable<IsThrowing> const table;
-    return &table;
+  static constexpr type get_empty_invocation_table() noexcept {
+    return &static_table<empty_vtable<IsThrowing>>::value;
   }
 };
 
@@ -825,6 +1699,72 @@ class operator_impl;
 
 FU2_DETAIL_EXPAND_QUALIFIERS(FU2_DEFINE_FUNCTION_TRAIT)
 #undef FU2_DEFINE_FUNCTION_TRAIT
+
+/// Batch signatures don't provide a call operator, they are always
+/// followed by their plain signature which provides it.
+template <std::size_t Index, typename Function, typename Signature,
+          typename Next, typename... Signatures>
+class operator_impl<Index, Function, batch<Signature>, Next, Signatures...>
+    : operator_impl<Index + 1, Function, Next, Signatures...> {
+
+  template <std::size_t, typename, typename...>
+  friend class operator_impl;
+
+protected:
+  operator_impl() = default;
+  ~operator_impl() = default;
+  operator_impl(operator_impl const&) = default;
+  operator_impl(operator_impl&&) = default;
+  operator_impl& operator=(operator_impl const&) = default;
+  operator_impl& operator=(operator_impl&&) = default;
+
+  using operator_impl<Index + 1, Function, Next, Signatures...>::operator();
+};
+
+/// Expands every batch signature into the batch signature itself
+/// followed by its plain signature
+template <typename Expanded, typename... Signatures>
+struct expand_batches {
+  using type = Expanded;
+};
+template <typename... Expanded, typename First, typename... Rest>
+struct expand_batches<identity<Expanded...>, First, Rest...>
+    : expand_batches<identity<Expanded..., First>, Rest...> {};
+template <typename... Expanded, typename Signature, typename... Rest>
+struct expand_batches<identity<Expanded...>, batch<Signature>, Rest...>
+    : expand_batches<identity<Expanded..., batch<Signature>, Signature>,
+                     Rest...> {};
+
+/// Declares the same call operators as the operator_impl of the given
+/// signatures, where every call operator returns its signature, which
+/// deduces the signature that is selected by a call to the function.
+template <typename... Signatures>
+struct signature_probe;
+
+#define FU2_DEFINE_SIGNATURE_PROBE(CONST, VOLATILE, NOEXCEPT, OVL_REF, REF)    \
+  template <typename Ret, typename... Args, typename Next,                     \
+            typename... Signatures>                                            \
+  struct signature_probe<Ret(Args...) CONST VOLATILE OVL_REF NOEXCEPT, Next,   \
+                         Signatures...>                                        \
+      : signature_probe<Next, Signatures...> {                                 \
+    using signature_probe<Next, Signatures...>::operator();                    \
+                                                                               \
+    identity<Ret(Args...) CONST VOLATILE OVL_REF NOEXCEPT>                     \
+    operator()(Args... args) CONST VOLATILE OVL_REF;                           \
+  };                                                                           \
+  template <typename Ret, typename... Args>                                    \
+  struct signature_probe<Ret(Args...) CONST VOLATILE OVL_REF NOEXCEPT> {       \
+    identity<Ret(Args...) CONST VOLATILE OVL_REF NOEXCEPT>                     \
+    operator()(Args... args) CONST VOLATILE OVL_REF;                           \
+  };
+
+FU2_DETAIL_EXPAND_QUALIFIERS(FU2_DEFINE_SIGNATURE_PROBE)
+#undef FU2_DEFINE_SIGNATURE_PROBE
+
+/// Batch signatures don't provide a call operator
+template <typename Signature, typename Next, typename... Signatures>
+struct signature_probe<batch<Signature>, Next, Signatures...>
+    : signature_probe<Next, Signatures...> {};
 } // namespace invocation_table
 
 namespace tables {
@@ -834,29 +1774,310 @@ enum class opcode {
   op_copy,         ///< Copy the object and set the vtable
   op_destroy,      ///< Destroy the object and reset the vtable
   op_weak_destroy, ///< Destroy the object without resetting the vtable
-  op_fetch_empty,  ///< Stores true or false into the to storage
-                   ///< to indicate emptiness
+};
+
+/// The command function of an erased object together with properties of
+/// the object, which allow to skip the command function for trivial
+/// operations on it.
+///
+/// The command function is kept at the beginning of the table,
+/// so it is loaded from the table pointer without any offset.
+template <typename Command>
+struct command_table {
+  Command cmd_;
+  /// Is true when the table belongs to an empty function
+  bool is_empty_;
+  /// Is true when the object is moved by copying its storage bitwise
+  bool is_trivially_relocatable_;
+  /// Is true when the object is copied by copying its storage bitwise
+  bool is_trivially_copyable_;
+  /// Is true when the object doesn't require any destruction
+  bool is_trivially_destructible_;
+  /// Is true when the storage holds a heap block acquired through reserve
+  bool is_reserved_;
+  /// Is true when the storage doesn't hold any state of the object
+  bool is_stateless_;
+  /// Identifies the type and the placement of the erased object
+  void const* type_;
+};
+
+/// Deduces to a true type if the box is relocated and copied bitwise when
+/// it is allocated inplace, which requires the box to be trivial and
+/// to not require a stricter alignment than the storage guarantees.
+/// Stateless boxes are relocated without touching the storage at all.
+template <typename T>
+struct is_trivially_relocatable_inplace
+    : std::integral_constant<bool,
+                             is_stateless_box<T>::value ||
+                                 (is_trivially_copyable_box<T>::value &&
+                                  (alignof(T) <= alignof(data_accessor)))> {};
+
+/// Returns the command table of an erased object of type T
+///
+/// Objects allocated on the heap are relocated by copying their pointer,
+/// objects allocated inplace only when they are trivial.
+template <typename Command, Command Cmd, typename T, typename Placement,
+          bool IsInplace = std::is_same<Placement, std::true_type>::value>
+constexpr command_table<Command> make_command_table() noexcept {
+  return {Cmd,
+          false,
+          !IsInplace || is_trivially_relocatable_inplace<T>::value,
+          IsInplace && is_trivially_relocatable_inplace<T>::value,
+          IsInplace && is_trivially_destructible_box<T>::value,
+          false,
+          IsInplace && is_stateless_box<T>::value,
+          &type_id<box_identity_t<T>, Placement>::id};
+}
+
+/// Returns the command table of an empty function
+template <typename Command, Command Cmd>
+constexpr command_table<Command> make_empty_command_table() noexcept {
+  return {Cmd, true, true, true, true, false, true, nullptr};
+}
+
+/// Returns the command table of a reserved heap block, which is relocated
+/// by copying its pointer but always requires the command function
+/// to be copied or destroyed.
+template <typename Command, Command Cmd, typename T>
+constexpr command_table<Command> make_reserved_command_table() noexcept {
+  return {Cmd,
+          false,
+          true,
+          false,
+          false,
+          true,
+          false,
+          &type_id<box_identity_t<T>, std::false_type>::id};
+}
+/// Returns the command table of an empty reserved heap block
+template <typename Command, Command Cmd>
+constexpr command_table<Command> make_reserved_empty_command_table() noexcept {
+  return {Cmd, true, true, false, false, true, false, nullptr};
+}
+
+/// The static command table for a present object
+template <typename Command, Command Cmd, typename T, typename Placement>
+struct object_command : command_table<Command> {
+  constexpr object_command() noexcept
+      : command_table<Command>(
+            make_command_table<Command, Cmd, T, Placement>()) {
+  }
+};
+
+/// The static command table for an empty wrapper
+template <typename Command, Command Cmd>
+struct empty_command : command_table<Command> {
+  constexpr empty_command() noexcept
+      : command_table<Command>(make_empty_command_table<Command, Cmd>()) {
+  }
+};
+
+/// The static command table for a reserved heap block which holds
+/// an object of type T
+template <typename Command, Command Cmd, typename T>
+struct reserved_command : command_table<Command> {
+  constexpr reserved_command() noexcept
+      : command_table<Command>(
+            make_reserved_command_table<Command, Cmd, T>()) {
+  }
+};
+
+/// The static command table for an empty reserved heap block
+template <typename Command, Command Cmd>
+struct reserved_empty_command : command_table<Command> {
+  constexpr reserved_empty_command() noexcept
+      : command_table<Command>(
+            make_reserved_empty_command_table<Command, Cmd>()) {
+  }
+};
+
+/// Stores the command table and the invocation table side by side
+/// inside the function object.
+template <table_layout Layout, typename Command, typename... FormalArgs>
+class table_storage {
+  using invoke_table_t = invocation_table::invoke_table<FormalArgs...>;
+
+  command_table<Command> const* cmd_;
+  typename invoke_table_t::type vtable_;
+
+public:
+  constexpr command_table<Command> const& command() const noexcept {
+    return *cmd_;
+  }
+
+  template <std::size_t Index>
+  constexpr auto fetch() const noexcept {
+    return invoke_table_t::template fetch<Index>(vtable_);
+  }
+  template <std::size_t Index>
+  constexpr auto fetch() const volatile noexcept {
+    return invoke_table_t::template fetch<Index>(vtable_);
+  }
+
+  template <typename CommandTable, typename T, typename Placement>
+  void set() noexcept {
+    vtable_ = invoke_table_t::template get_invocation_table_of<T, Placement>();
+    cmd_ = &static_table<CommandTable>::value;
+  }
+
+  template <typename CommandTable, bool IsThrowing>
+  void set_empty() noexcept {
+    vtable_ = invoke_table_t::template get_empty_invocation_table<IsThrowing>();
+    cmd_ = &static_table<CommandTable>::value;
+  }
+
+  template <typename CommandTable, bool IsThrowing>
+  constexpr bool is_empty() const noexcept {
+    return cmd_ == &static_table<CommandTable>::value;
+  }
+};
+
+/// Stores a single pointer to a static table inside the function object,
+/// which merges the command table and all invokers of the erased object.
+template <typename Command, typename... FormalArgs>
+class table_storage<table_layout::merged, Command, FormalArgs...> {
+  using invokers_t =
+      std::tuple<invocation_table::function_pointer_of<FormalArgs>...>;
+
+  struct merged_table {
+    command_table<Command> command_;
+    invokers_t invokers_;
+  };
+
+  /// The merged table for a present object
+  template <typename CommandTable, typename T, typename Placement>
+  struct object_table : merged_table {
+    constexpr object_table() noexcept
+        : merged_table{CommandTable{},
+                       invokers_t(&invocation_table::function_trait<
+                                  FormalArgs>::template internal_invoker<
+                                  T, Placement>::invoke...)} {
+    }
+  };
+
+  /// The merged table for an empty wrapper
+  template <typename CommandTable, bool IsThrowing>
+  struct empty_table : merged_table {
+    constexpr empty_table() noexcept
+        : merged_table{CommandTable{},
+                       invokers_t(&invocation_table::function_trait<
+                                  FormalArgs>::template empty_invoker<
+                                  IsThrowing>::invoke...)} {
+    }
+  };
+
+  merged_table const* table_;
+
+public:
+  constexpr command_table<Command> const& command() const noexcept {
+    return table_->command_;
+  }
+
+  template <std::size_t Index>
+  constexpr auto fetch() const noexcept {
+    return std::get<Index>(table_->invokers_);
+  }
+  template <std::size_t Index>
+  constexpr auto fetch() const volatile noexcept {
+    return std::get<Index>(table_->invokers_);
+  }
+
+  template <typename CommandTable, typename T, typename Placement>
+  void set() noexcept {
+    table_ = &static_table<object_table<CommandTable, T, Placement>>::value;
+  }
+
+  template <typename CommandTable, bool IsThrowing>
+  void set_empty() noexcept {
+    table_ = &static_table<empty_table<CommandTable, IsThrowing>>::value;
+  }
+
+  template <typename CommandTable, bool IsThrowing>
+  constexpr bool is_empty() const noexcept {
+    using table_t = empty_table<CommandTable, IsThrowing>;
+    return table_ == &static_table<table_t>::value;
+  }
+};
+
+/// Stores a pointer to the command table together with the invokers of
+/// all signatures inside the function object.
+template <typename Command, typename... FormalArgs>
+class table_storage<table_layout::inlined, Command, FormalArgs...> {
+  using invokers_t =
+      std::tuple<invocation_table::function_pointer_of<FormalArgs>...>;
+
+  command_table<Command> const* cmd_;
+  invokers_t invokers_;
+
+public:
+  constexpr command_table<Command> const& command() const noexcept {
+    return *cmd_;
+  }
+
+  template <std::size_t Index>
+  constexpr auto fetch() const noexcept {
+    return std::get<Index>(invokers_);
+  }
+  template <std::size_t Index>
+  constexpr auto fetch() const volatile noexcept {
+    // The invokers are never modified through a volatile function
+    return std::get<Index>(const_cast<invokers_t const&>(invokers_));
+  }
+
+  template <typename CommandTable, typename T, typename Placement>
+  void set() noexcept {
+    invokers_ = invokers_t(
+        &invocation_table::function_trait<
+            FormalArgs>::template internal_invoker<T, Placement>::invoke...);
+    cmd_ = &static_table<CommandTable>::value;
+  }
+
+  template <typename CommandTable, bool IsThrowing>
+  void set_empty() noexcept {
+    invokers_ = invokers_t(
+        &invocation_table::function_trait<
+            FormalArgs>::template empty_invoker<IsThrowing>::invoke...);
+    cmd_ = &static_table<CommandTable>::value;
+  }
+
+  template <typename CommandTable, bool IsThrowing>
+  constexpr bool is_empty() const noexcept {
+    return cmd_ == &static_table<CommandTable>::value;
+  }
 };
 
 /// Abstraction for a vtable together with a command table
 /// TODO Add optimization for a single formal argument
-/// TODO Add optimization to merge both tables if the function is size
-/// optimized
-template <typename Property>
+///
+/// Depending on the Layout both tables are either stored inside the
+/// function object, merged into a single static table or the invokers
+/// are stored inside the function object directly.
+///
+/// The Inplace rule restricts the objects which are allocated inplace,
+/// such that moving the function never throws or is always bitwise.
+///
+/// The Sharing rule decides whether objects allocated on the heap are
+/// shared between copies through a reference counted block.
+///
+/// When IsStrict is true all objects are allocated inplace,
+/// and the paths which allocate objects on the heap are never instantiated.
+template <typename Property, table_layout Layout, inplace_rule Inplace,
+          sharing_rule Sharing, bool IsStrict>
 class vtable;
 template <bool IsThrowing, bool HasStrongExceptGuarantee,
-          typename... FormalArgs>
-class vtable<property<IsThrowing, HasStrongExceptGuarantee, FormalArgs...>> {
+          typename... FormalArgs, table_layout Layout, inplace_rule Inplace,
+          sharing_rule Sharing, bool IsStrict>
+class vtable<property<IsThrowing, HasStrongExceptGuarantee, FormalArgs...>,
+             Layout, Inplace, Sharing, IsStrict> {
   using command_function_t = void (*)(vtable* /*this*/, opcode /*op*/,
                                       data_accessor* /*from*/,
-                                      std::size_t /*from_capacity*/,
                                       data_accessor* /*to*/,
-                                      std::size_t /*to_capacity*/);
+                                      std::size_t /*to_capacity*/,
+                                      std::size_t /*to_alignment*/);
 
-  using invoke_table_t = invocation_table::invoke_table<FormalArgs...>;
+  using counter_t = shared_counter<Sharing == sharing_rule::atomic>;
 
-  command_function_t cmd_;
-  typename invoke_table_t::type vtable_;
+  table_storage<Layout, command_function_t, FormalArgs...> tables_;
 
   template <typename T>
   struct trait {
@@ -866,14 +2087,14 @@ class vtable<property<IsThrowing, HasStrongExceptGuarantee, FormalArgs...>> {
     /// The command table
     template <bool IsInplace>
     static void process_cmd(vtable* to_table, opcode op, data_accessor* from,
-                            std::size_t from_capacity, data_accessor* to,
-                            std::size_t to_capacity) {
+                            data_accessor* to, std::size_t to_capacity,
+                            std::size_t to_alignment) {
 
       switch (op) {
         case opcode::op_move: {
           /// Retrieve the pointer to the object
-          auto box = static_cast<T*>(retrieve<T>(
-              std::integral_constant<bool, IsInplace>{}, from, from_capacity));
+          auto box = static_cast<T*>(
+              retrieve<T>(std::integral_constant<bool, IsInplace>{}, from));
           assert(box && "The object must not be over aligned or null!");
 
           if (!IsInplace) {
@@ -893,14 +2114,14 @@ class vtable<property<IsThrowing, HasStrongExceptGuarantee, FormalArgs...>> {
           // The object is allocated inplace
           else {
             construct(std::true_type{}, std::move(*box), to_table, to,
-                      to_capacity);
+                      to_capacity, to_alignment);
             box->~T();
           }
           return;
         }
         case opcode::op_copy: {
-          auto box = static_cast<T const*>(retrieve<T>(
-              std::integral_constant<bool, IsInplace>{}, from, from_capacity));
+          auto box = static_cast<T const*>(
+              retrieve<T>(std::integral_constant<bool, IsInplace>{}, from));
           assert(box && "The object must not be over aligned or null!");
 
           assert(std::is_copy_constructible<T>::value &&
@@ -908,15 +2129,15 @@ class vtable<property<IsThrowing, HasStrongExceptGuarantee, FormalArgs...>> {
 
           // Try to allocate the object inplace
           construct(std::is_copy_constructible<T>{}, *box, to_table, to,
-                    to_capacity);
+                    to_capacity, to_alignment);
           return;
         }
         case opcode::op_destroy:
         case opcode::op_weak_destroy: {
 
           assert(!to && !to_capacity && "Arg overflow!");
-          auto box = static_cast<T*>(retrieve<T>(
-              std::integral_constant<bool, IsInplace>{}, from, from_capacity));
+          auto box = static_cast<T*>(
+              retrieve<T>(std::integral_constant<bool, IsInplace>{}, from));
 
           if (IsInplace) {
             box->~T();
@@ -929,45 +2150,276 @@ class vtable<property<IsThrowing, HasStrongExceptGuarantee, FormalArgs...>> {
           }
           return;
         }
-        case opcode::op_fetch_empty: {
-          write_empty(to, false);
-          return;
-        }
       }
 
       FU2_DETAIL_UNREACHABLE();
     }
 
-    template <typename Box>
-    static void
-    construct(std::true_type /*apply*/, Box&& box, vtable* to_table,
-              data_accessor* to,
-              std::size_t to_capacity) noexcept(HasStrongExceptGuarantee) {
-      // Try to allocate the object inplace
-      void* storage = retrieve<T>(std::true_type{}, to, to_capacity);
-      if (storage) {
-        to_table->template set_inplace<T>();
-      } else {
-        // Allocate the object through the allocator
-        to->ptr_ = storage =
-            box_factory<std::decay_t<Box>>::box_allocate(std::addressof(box));
-        to_table->template set_allocated<T>();
-      }
-      new (storage) T(std::forward<Box>(box));
+    /// The command table for objects stored inside a reserved heap block
+    static void process_reserved_cmd(vtable* to_table, opcode op,
+                                     data_accessor* from, data_accessor* to,
+                                     std::size_t to_capacity,
+                                     std::size_t to_alignment) {
+
+      switch (op) {
+        case opcode::op_move: {
+          // The block is handed over together with the object
+          to->ptr_ = from->ptr_;
+          to_table->template set_reserved<T>();
+          return;
+        }
+        case opcode::op_copy: {
+          auto box = static_cast<T const*>(from->ptr_);
+
+          assert(std::is_copy_constructible<T>::value &&
+                 "The box is required to be copyable here!");
+
+          // The copy never shares the reserved block
+          construct(std::is_copy_constructible<T>{}, *box, to_table, to,
+                    to_capacity, to_alignment);
+          return;
+        }
+        case opcode::op_destroy: {
+          assert(!to && !to_capacity && "Arg overflow!");
+
+          // Keep the block for later assignments
+          static_cast<T*>(from->ptr_)->~T();
+          to_table->set_reserved_empty();
+          return;
+        }
+        case opcode::op_weak_destroy: {
+          assert(!to && !to_capacity && "Arg overflow!");
+
+          static_cast<T*>(from->ptr_)->~T();
+          reserved_deallocate(from->ptr_);
+          return;
+        }
+      }
+
+      FU2_DETAIL_UNREACHABLE();
+    }
+
+    /// The command table for objects stored inside a shared heap block
+    static void process_shared_cmd(vtable* to_table, opcode op,
+                                   data_accessor* from, data_accessor* to,
+                                   std::size_t to_capacity,
+                                   std::size_t to_alignment) {
+
+      switch (op) {
+        case opcode::op_move: {
+          // The reference is handed over together with the pointer
+          to->ptr_ = from->ptr_;
+          to_table->template set_shared<T>();
+          return;
+        }
+        case opcode::op_copy: {
+          shared_block_of<T, counter_t>(from)->counter_.acquire();
+          to->ptr_ = from->ptr_;
+          to_table->template set_shared<T>();
+          return;
+        }
+        case opcode::op_destroy:
+        case opcode::op_weak_destroy: {
+          assert(!to && !to_capacity && "Arg overflow!");
+          (void)to_capacity;
+          (void)to_alignment;
+
+          auto block = shared_block_of<T, counter_t>(from);
+          if (block->counter_.release()) {
+            box_factory<T>::block_deallocate(block);
+          }
+
+          if (op == opcode::op_destroy) {
+            to_table->set_empty();
+          }
+          return;
+        }
+      }
+
+      FU2_DETAIL_UNREACHABLE();
+    }
+
+    /// Returns the inplace storage for the object, or a null pointer
+    /// if the object has to be allocated on the heap
+    static void* inplace_storage(data_accessor* to,
+                                 std::size_t to_capacity,
+                                 std::size_t to_alignment) noexcept {
+      if (((Inplace == inplace_rule::nothrow_movable) &&
+           !std::is_nothrow_move_constructible<T>::value) ||
+          ((Inplace == inplace_rule::trivially_relocatable) &&
+           !is_trivially_relocatable_inplace<T>::value)) {
+        return nullptr;
+      }
+      return inplace_storage_of<T>(to, to_capacity, to_alignment);
+    }
+
+    template <typename Box>
+    static void
+    construct(std::true_type /*apply*/, Box&& box, vtable* to_table,
+              data_accessor* to, std::size_t to_capacity,
+              std::size_t to_alignment) noexcept(HasStrongExceptGuarantee) {
+      construct_at(
+          std::integral_constant<bool,
+                                 IsStrict || is_stateless_box<T>::value>{},
+          std::forward<Box>(box), to_table, to, to_capacity,
+          to_alignment);
     }
 
     template <typename Box>
     static void
     construct(std::false_type /*apply*/, Box&& /*box*/, vtable* /*to_table*/,
-              data_accessor* /*to*/,
-              std::size_t /*to_capacity*/) noexcept(HasStrongExceptGuarantee) {
+              data_accessor* /*to*/, std::size_t /*to_capacity*/,
+              std::size_t /*to_alignment*/) noexcept(HasStrongExceptGuarantee) {
+    }
+
+    /// Constructs the object inside the internal capacity, which is always
+    /// large enough for strict functions and stateless objects.
+    template <typename Box>
+    static void
+    construct_at(std::true_type /*is_strict*/, Box&& box, vtable* to_table,
+                 data_accessor* to, std::size_t to_capacity,
+                 std::size_t to_alignment) noexcept(HasStrongExceptGuarantee) {
+      void* storage = inplace_storage(to, to_capacity, to_alignment);
+      assert(storage && "The object must fit into the internal capacity!");
+
+      to_table->template set_inplace<T>();
+      new (storage) T(std::forward<Box>(box));
+    }
+
+    /// Constructs the object inside the internal capacity if it fits,
+    /// or on the heap otherwise
+    template <typename Box>
+    static void
+    construct_at(std::false_type /*is_strict*/, Box&& box, vtable* to_table,
+                 data_accessor* to, std::size_t to_capacity,
+                 std::size_t to_alignment) noexcept(HasStrongExceptGuarantee) {
+      // Try to allocate the object inplace
+      void* storage = inplace_storage(to, to_capacity, to_alignment);
+      if (storage) {
+        to_table->template set_inplace<T>();
+      } else if (Sharing != sharing_rule::none) {
+        // Allocate a shared block through the allocator
+        using block_t = shared_block<T, counter_t>;
+        block_t* block = box_factory<T>::template block_allocate<block_t>(
+            std::addressof(box));
+        new (block) block_t(std::forward<Box>(box));
+        to->ptr_ = static_cast<T*>(block);
+        to_table->template set_shared<T>();
+        return;
+      } else {
+        // Allocate the object through the allocator
+        to->ptr_ = storage =
+            box_factory<std::decay_t<Box>>::box_allocate(std::addressof(box));
+        to_table->template set_allocated<T>();
+      }
+      new (storage) T(std::forward<Box>(box));
+    }
+
+    /// Constructs the box from the given arguments directly
+    /// inside its final storage
+    template <typename Allocator, typename... Args>
+    static T* construct_in_place(vtable* to_table, data_accessor* to,
+                                 std::size_t to_capacity,
+                                 std::size_t to_alignment,
+                                 Allocator const& allocator_, Args&&... args) {
+      return construct_in_place_at(
+          std::integral_constant<bool,
+                                 IsStrict || is_stateless_box<T>::value>{},
+          to_table, to, to_capacity, to_alignment, allocator_,
+          std::forward<Args>(args)...);
+    }
+
+    template <typename Allocator, typename... Args>
+    static T* construct_in_place_at(std::true_type /*is_strict*/,
+                                    vtable* to_table, data_accessor* to,
+                                    std::size_t to_capacity,
+                                    std::size_t to_alignment,
+                                    Allocator const& allocator_,
+                                    Args&&... args) {
+      using tag_t =
+          in_place_type_t<std::decay_t<decltype(std::declval<T&>().value_)>>;
+
+      void* storage = inplace_storage(to, to_capacity, to_alignment);
+      assert(storage && "The object must fit into the internal capacity!");
+
+      auto box =
+          new (storage) T(tag_t{}, allocator_, std::forward<Args>(args)...);
+      to_table->template set_inplace<T>();
+      return box;
+    }
+
+    template <typename Allocator, typename... Args>
+    static T* construct_in_place_at(std::false_type /*is_strict*/,
+                                    vtable* to_table, data_accessor* to,
+                                    std::size_t to_capacity,
+                                    std::size_t to_alignment,
+                                    Allocator const& allocator_,
+                                    Args&&... args) {
+      using tag_t =
+          in_place_type_t<std::decay_t<decltype(std::declval<T&>().value_)>>;
+
+      if (void* storage = inplace_storage(to, to_capacity, to_alignment)) {
+        auto box =
+            new (storage) T(tag_t{}, allocator_, std::forward<Args>(args)...);
+        to_table->template set_inplace<T>();
+        return box;
+      }
+
+      if (Sharing != sharing_rule::none) {
+        return construct_shared_in_place(to_table, to, allocator_,
+                                         std::forward<Args>(args)...);
+      }
+
+      // Allocate the object through the allocator
+      T* storage = box_factory<T>::box_allocate(allocator_);
+#if !defined(FU2_HAS_DISABLED_EXCEPTIONS)
+      try {
+        new (storage) T(tag_t{}, allocator_, std::forward<Args>(args)...);
+      } catch (...) {
+        box_factory<T>::box_release(allocator_, storage);
+        throw;
+      }
+#else
+      new (storage) T(tag_t{}, allocator_, std::forward<Args>(args)...);
+#endif
+      to->ptr_ = storage;
+      to_table->template set_allocated<T>();
+      return storage;
+    }
+
+    /// Constructs the box from the given arguments directly
+    /// inside a new shared heap block
+    template <typename Allocator, typename... Args>
+    static T* construct_shared_in_place(vtable* to_table, data_accessor* to,
+                                        Allocator const& allocator_,
+                                        Args&&... args) {
+      using tag_t =
+          in_place_type_t<std::decay_t<decltype(std::declval<T&>().value_)>>;
+      using block_t = shared_block<T, counter_t>;
+
+      block_t* block =
+          box_factory<T>::template block_allocate<block_t>(allocator_);
+#if !defined(FU2_HAS_DISABLED_EXCEPTIONS)
+      try {
+        new (block) block_t(tag_t{}, allocator_, std::forward<Args>(args)...);
+      } catch (...) {
+        box_factory<T>::block_release(allocator_, block);
+        throw;
+      }
+#else
+      new (block) block_t(tag_t{}, allocator_, std::forward<Args>(args)...);
+#endif
+      T* storage = block;
+      to->ptr_ = storage;
+      to_table->template set_shared<T>();
+      return storage;
     }
   };
 
   /// The command table
   static void empty_cmd(vtable* to_table, opcode op, data_accessor* /*from*/,
-                        std::size_t /*from_capacity*/, data_accessor* to,
-                        std::size_t /*to_capacity*/) {
+                        data_accessor* /*to*/, std::size_t /*to_capacity*/,
+                        std::size_t /*to_alignment*/) {
 
     switch (op) {
       case opcode::op_move:
@@ -980,8 +2432,34 @@ class vtable<property<IsThrowing, HasStrongExceptGuarantee, FormalArgs...>> {
         // Do nothing
         break;
       }
-      case opcode::op_fetch_empty: {
-        write_empty(to, true);
+      default: {
+        FU2_DETAIL_UNREACHABLE();
+      }
+    }
+  }
+
+  /// The command table for an empty reserved heap block
+  static void reserved_empty_cmd(vtable* to_table, opcode op,
+                                 data_accessor* from, data_accessor* to,
+                                 std::size_t /*to_capacity*/,
+                                 std::size_t /*to_alignment*/) {
+
+    switch (op) {
+      case opcode::op_move: {
+        to->ptr_ = from->ptr_;
+        to_table->set_reserved_empty();
+        break;
+      }
+      case opcode::op_copy: {
+        to_table->set_empty();
+        break;
+      }
+      case opcode::op_destroy: {
+        // Keep the block for later assignments
+        break;
+      }
+      case opcode::op_weak_destroy: {
+        reserved_deallocate(from->ptr_);
         break;
       }
       default: {
@@ -996,79 +2474,488 @@ public:
   /// Initialize an object at the given position
   template <typename T>
   static void init(vtable& table, T&& object, data_accessor* to,
-                   std::size_t to_capacity) {
+                   std::size_t to_capacity, std::size_t to_alignment) {
 
     trait<std::decay_t<T>>::construct(std::true_type{}, std::forward<T>(object),
-                                      &table, to, to_capacity);
+                                      &table, to, to_capacity,
+                                      to_alignment);
+  }
+
+  /// Replaces the object at the given position, which reuses the heap block
+  /// of the previous object instead of reallocating it when this is possible.
+  ///
+  /// The block is reused when it was acquired through reserve and
+  /// is large enough, or when the previous object is of the same type.
+  /// Both require an allocator which is always equal, since the block
+  /// wasn't obtained through the allocator of the new object.
+  /// Objects which fit into the internal capacity are always stored inplace,
+  /// which releases a reserved block.
+  template <typename T>
+  static void assign(vtable& table, T&& object, data_accessor* to,
+                     std::size_t to_capacity, std::size_t to_alignment) {
+    using type = std::decay_t<T>;
+
+    if (!IsStrict && !is_stateless_box<type>::value &&
+        is_stateless_allocator_box<type>::value &&
+        std::is_nothrow_move_constructible<type>::value) {
+      auto const& command = table.tables_.command();
+      if (command.is_reserved_) {
+        if (!trait<type>::inplace_storage(to, to_capacity, to_alignment) &&
+            reserved_can_hold<type>(to->ptr_)) {
+          table.destroy(to);
+          new (to->ptr_) type(std::forward<T>(object));
+          table.template set_reserved<type>();
+          return;
+        }
+      } else if (command.cmd_ == &trait<type>::template process_cmd<false>) {
+        static_cast<type*>(to->ptr_)->~type();
+        new (to->ptr_) type(std::forward<T>(object));
+        table.template set_allocated<type>();
+        return;
+      }
+    }
+
+    table.weak_destroy(to);
+    init(table, std::forward<T>(object), to, to_capacity, to_alignment);
+  }
+
+  /// Acquires a heap block of the given size at the given position,
+  /// which is reused by later assignments.
+  ///
+  /// The position is required to be empty, or to hold a reserved block
+  /// which is large enough already.
+  void reserve(data_accessor* to, std::size_t size) {
+    auto const& command = tables_.command();
+    if (command.is_reserved_ && (size <= reserved_size(to->ptr_))) {
+      return;
+    }
+
+    assert(empty() && "A heap block can only be reserved while empty!");
+    if (!empty()) {
+      return;
+    }
+
+    void* block = reserved_allocate(size);
+    weak_destroy(to);
+    to->ptr_ = block;
+    set_reserved_empty();
+  }
+
+  /// Constructs a box at the given position from the given arguments
+  template <typename Box, typename Allocator, typename... Args>
+  static Box* init_in_place(vtable& table, data_accessor* to,
+                            std::size_t to_capacity, std::size_t to_alignment,
+                            Allocator const& allocator_, Args&&... args) {
+    return trait<Box>::construct_in_place(&table, to, to_capacity,
+                                          to_alignment, allocator_,
+                                          std::forward<Args>(args)...);
+  }
+
+  /// Replaces the object at the given position by a box constructed
+  /// from the given arguments, which is placed inside the reserved heap
+  /// block if there is one that is large enough and the box doesn't fit
+  /// into the internal capacity. Boxes with an allocator which isn't
+  /// always equal are allocated through their allocator instead.
+  template <typename Box, typename Allocator, typename... Args>
+  static Box* emplace(vtable& table, data_accessor* to,
+                      std::size_t to_capacity, std::size_t to_alignment,
+                      Allocator const& allocator_,
+                      Args&&... args) {
+    using tag_t =
+        in_place_type_t<std::decay_t<decltype(std::declval<Box&>().value_)>>;
+
+    auto const& command = table.tables_.command();
+    if (!IsStrict && !is_stateless_box<Box>::value &&
+        is_stateless_allocator_box<Box>::value && command.is_reserved_ &&
+        !trait<Box>::inplace_storage(to, to_capacity, to_alignment) &&
+        reserved_can_hold<Box>(to->ptr_)) {
+      table.destroy(to);
+      auto box =
+          new (to->ptr_) Box(tag_t{}, allocator_, std::forward<Args>(args)...);
+      table.template set_reserved<Box>();
+      return box;
+    }
+
+    table.weak_destroy(to);
+    table.set_empty();
+    return init_in_place<Box>(table, to, to_capacity, to_alignment, allocator_,
+                              std::forward<Args>(args)...);
   }
 
   /// Moves the object at the given position
-  void move(vtable& to_table, data_accessor* from, std::size_t from_capacity,
-            data_accessor* to,
-            std::size_t to_capacity) noexcept(HasStrongExceptGuarantee) {
-    cmd_(&to_table, opcode::op_move, from, from_capacity, to, to_capacity);
+  void move(vtable& to_table, data_accessor* from, data_accessor* to,
+            std::size_t to_capacity,
+            std::size_t to_alignment) noexcept(HasStrongExceptGuarantee) {
+    tables_.command().cmd_(&to_table, opcode::op_move, from, to, to_capacity,
+                           to_alignment);
     set_empty();
   }
 
-  /// Destroys the object at the given position
+  /// Moves the object at the given position into a storage of the same
+  /// capacity, which copies the storage bitwise if this is possible.
+  template <std::size_t Capacity, std::size_t Alignment>
+  void relocate(vtable& to_table, data_accessor* from,
+                data_accessor* to) noexcept(HasStrongExceptGuarantee) {
+    auto const& command = tables_.command();
+    if (command.is_trivially_relocatable_) {
+      if (!command.is_stateless_) {
+        std::memcpy(to, from, Capacity);
+      }
+      to_table.tables_ = tables_;
+      set_empty();
+    } else {
+      move(to_table, from, to, Capacity, Alignment);
+    }
+  }
+
+  /// Copies the object at the given position into a storage of the same
+  /// capacity, which copies the storage bitwise if this is possible.
+  template <std::size_t Capacity, std::size_t Alignment>
   void copy(vtable& to_table, data_accessor const* from,
-            std::size_t from_capacity, data_accessor* to,
-            std::size_t to_capacity) const {
-    cmd_(&to_table, opcode::op_copy, const_cast<data_accessor*>(from),
-         from_capacity, to, to_capacity);
+            data_accessor* to) const {
+    auto const& command = tables_.command();
+    if (command.is_trivially_copyable_) {
+      if (!command.is_stateless_) {
+        std::memcpy(to, from, Capacity);
+      }
+      to_table.tables_ = tables_;
+    } else {
+      command.cmd_(&to_table, opcode::op_copy,
+                   const_cast<data_accessor*>(from), to, Capacity, Alignment);
+    }
   }
 
   /// Destroys the object at the given position
-  void destroy(data_accessor* from,
-               std::size_t from_capacity) noexcept(HasStrongExceptGuarantee) {
-    cmd_(this, opcode::op_destroy, from, from_capacity, nullptr, 0U);
+  void destroy(data_accessor* from) noexcept(HasStrongExceptGuarantee) {
+    auto const& command = tables_.command();
+    if (command.is_trivially_destructible_) {
+      set_empty();
+    } else {
+      command.cmd_(this, opcode::op_destroy, from, nullptr, 0U, 0U);
+    }
   }
 
   /// Destroys the object at the given position without invalidating the
   /// vtable
-  void
-  weak_destroy(data_accessor* from,
-               std::size_t from_capacity) noexcept(HasStrongExceptGuarantee) {
-    cmd_(this, opcode::op_weak_destroy, from, from_capacity, nullptr, 0U);
+  void weak_destroy(data_accessor* from) noexcept(HasStrongExceptGuarantee) {
+    auto const& command = tables_.command();
+    if (!command.is_trivially_destructible_) {
+      command.cmd_(this, opcode::op_weak_destroy, from, nullptr, 0U, 0U);
+    }
   }
 
-  /// Returns true when the vtable doesn't hold any erased object
+  /// Returns true when the vtable doesn't hold any erased object,
+  /// which compares the table pointer against the empty tables
+  /// without loading the table itself.
   bool empty() const noexcept {
-    data_accessor data;
-    cmd_(nullptr, opcode::op_fetch_empty, nullptr, 0U, &data, 0U);
-    return bool(data.inplace_storage_);
+    using empty_t = empty_command<command_function_t, &empty_cmd>;
+    using reserved_empty_t =
+        reserved_empty_command<command_function_t, &reserved_empty_cmd>;
+
+    return tables_.template is_empty<empty_t, IsThrowing>() ||
+           (!IsStrict &&
+            tables_.template is_empty<reserved_empty_t, IsThrowing>());
+  }
+
+  /// Returns true when the erased object may be relocated bitwise
+  bool is_trivially_relocatable() const noexcept {
+    return tables_.command().is_trivially_relocatable_;
   }
 
   /// Invoke the function at the given index
-  template <std::size_t Index, typename... Args>
-  constexpr decltype(auto) invoke(Args&&... args) const {
-    auto thunk = invoke_table_t::template fetch<Index>(vtable_);
-    return thunk(std::forward<Args>(args)...);
+  template <std::size_t Index, typename Accessor, typename... Args>
+  constexpr decltype(auto) invoke(Accessor from, Args&&... args) const {
+    auto thunk = tables_.template fetch<Index>();
+    return thunk(invocation_table::context_of(from),
+                 std::forward<Args>(args)...);
   }
   /// Invoke the function at the given index
-  template <std::size_t Index, typename... Args>
-  constexpr decltype(auto) invoke(Args&&... args) const volatile {
-    auto thunk = invoke_table_t::template fetch<Index>(vtable_);
-    return thunk(std::forward<Args>(args)...);
+  template <std::size_t Index, typename Accessor, typename... Args>
+  constexpr decltype(auto) invoke(Accessor from,
+                                  Args&&... args) const volatile {
+    auto thunk = tables_.template fetch<Index>();
+    return thunk(invocation_table::context_of(from),
+                 std::forward<Args>(args)...);
+  }
+
+  /// Returns the thunk of the function at the given index
+  template <std::size_t Index>
+  constexpr auto thunk() const noexcept {
+    return tables_.template fetch<Index>();
   }
 
+  /// Returns the address of the erased object if it is held by a box
+  /// of type Box, or a null pointer otherwise.
+  ///
+  /// The type is identified by comparing the address of its type_id,
+  /// a shared object is copied before it is returned as mutable object.
+  template <typename Box, typename Accessor>
+  auto target(Accessor from) const {
+    void const* type = tables_.command().type_;
+    if (type == &type_id<box_identity_t<Box>, std::true_type>::id) {
+      return target_of<Box>(std::true_type{}, from);
+    }
+    if (type == &type_id<box_identity_t<Box>, std::false_type>::id) {
+      return target_of<Box>(std::false_type{}, from);
+    }
+    return shared_target<Box>(
+        std::integral_constant<bool, Sharing != sharing_rule::none>{}, type,
+        from);
+  }
+
+private:
+  template <typename Box, typename Placement, typename Accessor>
+  static auto target_of(Placement, Accessor from) {
+    using box_t = transfer_const_t<Accessor, Box>;
+    return std::addressof(
+        static_cast<box_t*>(retrieve<Box>(Placement{}, from))->value_);
+  }
+
+  template <typename Box, typename Accessor>
+  static auto shared_target(std::true_type /*is_shared*/, void const* type,
+                            Accessor from) {
+    using placement_t = shared_placement<counter_t>;
+    if (type == &type_id<box_identity_t<Box>, placement_t>::id) {
+      return target_of<Box>(placement_t{}, from);
+    }
+    return shared_target<Box>(std::false_type{}, type, from);
+  }
+  template <typename Box, typename Accessor>
+  static auto shared_target(std::false_type /*is_shared*/,
+                            void const* /*type*/, Accessor /*from*/) {
+    using value_t = decltype(std::declval<Box&>().value_);
+    return static_cast<transfer_const_t<Accessor, value_t>*>(nullptr);
+  }
+
+public:
   template <typename T>
   void set_inplace() noexcept {
     using type = std::decay_t<T>;
-    vtable_ = invoke_table_t::template get_invocation_table_of<type, true>();
-    cmd_ = &trait<type>::template process_cmd<true>;
+    tables_.template set<
+        object_command<command_function_t,
+                       &trait<type>::template process_cmd<true>, type,
+                       std::true_type>,
+        type, std::true_type>();
   }
 
   template <typename T>
   void set_allocated() noexcept {
     using type = std::decay_t<T>;
-    vtable_ = invoke_table_t::template get_invocation_table_of<type, false>();
-    cmd_ = &trait<type>::template process_cmd<false>;
+    tables_.template set<
+        object_command<command_function_t,
+                       &trait<type>::template process_cmd<false>, type,
+                       std::false_type>,
+        type, std::false_type>();
+  }
+
+  template <typename T>
+  void set_shared() noexcept {
+    using type = std::decay_t<T>;
+    tables_.template set<
+        object_command<command_function_t, &trait<type>::process_shared_cmd,
+                       type, shared_placement<counter_t>>,
+        type, shared_placement<counter_t>>();
+  }
+
+  template <typename T>
+  void set_reserved() noexcept {
+    using type = std::decay_t<T>;
+    tables_.template set<
+        reserved_command<command_function_t,
+                         &trait<type>::process_reserved_cmd, type>,
+        type, std::false_type>();
   }
 
   void set_empty() noexcept {
-    vtable_ = invoke_table_t::template get_empty_invocation_table<IsThrowing>();
-    cmd_ = &empty_cmd;
+    tables_.template set_empty<empty_command<command_function_t, &empty_cmd>,
+                               IsThrowing>();
+  }
+
+  void set_reserved_empty() noexcept {
+    tables_.template set_empty<
+        reserved_empty_command<command_function_t, &reserved_empty_cmd>,
+        IsThrowing>();
+  }
+};
+
+/// Abstraction for the table of an object which is allocated inside a heap
+/// block together with a header that points to the table.
+/// The function only stores the pointer to the header, which is a null
+/// pointer when the function is empty.
+template <typename Property>
+class thin_vtable;
+template <bool IsThrowing, bool HasStrongExceptGuarantee,
+          typename... FormalArgs>
+class thin_vtable<
+    property<IsThrowing, HasStrongExceptGuarantee, FormalArgs...>> {
+  using invokers_t =
+      std::tuple<invocation_table::function_pointer_of<FormalArgs>...>;
+
+  struct table {
+    void (*copy_)(data_accessor const* /*from*/, data_accessor* /*to*/);
+    void (*destroy_)(data_accessor* /*from*/);
+    invokers_t invokers_;
+    /// Identifies the type of the erased object
+    void const* type_;
+  };
+
+  struct header {
+    table const* table_;
+  };
+
+  template <typename T>
+  struct object_table;
+
+  /// The heap block which holds the header in front of the box
+  template <typename T>
+  struct block : header, T {
+    template <typename... Args>
+    explicit block(Args&&... args)
+        : header{&static_table<object_table<T>>::value},
+          T(std::forward<Args>(args)...) {
+    }
+
+    static T* of(void* ptr) noexcept {
+      return static_cast<block*>(static_cast<header*>(ptr));
+    }
+  };
+
+  template <typename T>
+  struct trait {
+    static_assert(is_box<T>::value,
+                  "The trait must be specialized with a box!");
+
+    static block<T>* block_of(data_accessor const* from) noexcept {
+      return static_cast<block<T>*>(static_cast<header*>(from->ptr_));
+    }
+
+    static void copy(data_accessor const* from, data_accessor* to) {
+      copy_block(std::is_copy_constructible<T>{}, from, to);
+    }
+    static void copy_block(std::true_type /*apply*/, data_accessor const* from,
+                           data_accessor* to) {
+      to->ptr_ = static_cast<header*>(box_factory<T>::block_copy(
+          static_cast<block<T> const*>(block_of(from))));
+    }
+    static void copy_block(std::false_type /*apply*/,
+                           data_accessor const* /*from*/,
+                           data_accessor* /*to*/) {
+    }
+
+    static void destroy(data_accessor* from) {
+      box_factory<T>::block_deallocate(block_of(from));
+    }
+  };
+
+  /// The table for a present object
+  template <typename T>
+  struct object_table : table {
+    constexpr object_table() noexcept
+        : table{&trait<T>::copy, &trait<T>::destroy,
+                invokers_t(&invocation_table::function_trait<FormalArgs>::
+                               template internal_invoker<
+                                   T, thin_placement<block<T>>>::invoke...),
+                &type_id<box_identity_t<T>,
+                         thin_placement<block<box_identity_t<T>>>>::id} {
+    }
+  };
+
+  template <typename Accessor>
+  static header const* header_of(Accessor from) noexcept {
+    return static_cast<header const*>(from->ptr_);
+  }
+
+public:
+  /// Allocates a heap block for the given box at the given position
+  template <typename Box>
+  static void init(Box&& box, data_accessor* to) {
+    using block_t = block<std::decay_t<Box>>;
+
+    block_t* storage =
+        box_factory<std::decay_t<Box>>::template block_allocate<block_t>(
+            std::addressof(box));
+    new (storage) block_t(std::forward<Box>(box));
+    to->ptr_ = static_cast<header*>(storage);
+  }
+
+  /// Allocates a heap block at the given position and constructs
+  /// the box from the given arguments directly inside of it
+  template <typename Box, typename Allocator, typename... Args>
+  static Box* init_in_place(data_accessor* to, Allocator const& allocator_,
+                            Args&&... args) {
+    using tag_t =
+        in_place_type_t<std::decay_t<decltype(std::declval<Box&>().value_)>>;
+    using block_t = block<Box>;
+
+    block_t* storage =
+        box_factory<Box>::template block_allocate<block_t>(allocator_);
+#if !defined(FU2_HAS_DISABLED_EXCEPTIONS)
+    try {
+      new (storage) block_t(tag_t{}, allocator_, std::forward<Args>(args)...);
+    } catch (...) {
+      box_factory<Box>::block_release(allocator_, storage);
+      throw;
+    }
+#else
+    new (storage) block_t(tag_t{}, allocator_, std::forward<Args>(args)...);
+#endif
+    to->ptr_ = static_cast<header*>(storage);
+    return storage;
+  }
+
+  /// Copies the object at the given position into a new heap block
+  static void copy(data_accessor const* from, data_accessor* to) {
+    if (from->ptr_) {
+      header_of(from)->table_->copy_(from, to);
+    } else {
+      to->ptr_ = nullptr;
+    }
+  }
+
+  /// Destroys the object at the given position and releases its heap block
+  static void destroy(data_accessor* from) noexcept(HasStrongExceptGuarantee) {
+    if (from->ptr_) {
+      header_of(from)->table_->destroy_(from);
+      from->ptr_ = nullptr;
+    }
+  }
+
+  /// Returns the address of the erased object if it is held by a box
+  /// of type Box, or a null pointer otherwise.
+  template <typename Box, typename Accessor>
+  static auto target(Accessor from) noexcept {
+    using value_t = decltype(std::declval<Box&>().value_);
+    using pointer_t = transfer_const_t<Accessor, value_t>*;
+
+    using identity_t = box_identity_t<Box>;
+
+    if (from->ptr_ &&
+        (header_of(from)->table_->type_ ==
+         &type_id<identity_t, thin_placement<block<identity_t>>>::id)) {
+      return static_cast<pointer_t>(
+          std::addressof(block<Box>::of(from->ptr_)->value_));
+    }
+    return static_cast<pointer_t>(nullptr);
+  }
+
+  /// Returns the thunk of the function at the given index
+  template <std::size_t Index, typename Accessor>
+  static auto thunk(Accessor from) noexcept {
+    using signature_t = std::tuple_element_t<Index, std::tuple<FormalArgs...>>;
+
+    if (from->ptr_) {
+      return std::get<Index>(header_of(from)->table_->invokers_);
+    }
+    return invocation_table::function_pointer_of<signature_t>(
+        &invocation_table::function_trait<
+            signature_t>::template empty_invoker<IsThrowing>::invoke);
+  }
+
+  /// Invoke the function at the given index
+  template <std::size_t Index, typename Accessor, typename... Args>
+  static decltype(auto) invoke(Accessor from, Args&&... args) {
+    return thunk<Index>(from)(invocation_table::context_of(from),
+                              std::forward<Args>(args)...);
   }
 };
 } // namespace tables
@@ -1123,6 +3010,30 @@ public:
   static constexpr std::size_t capacity() noexcept {
     return sizeof(storage_);
   }
+  static constexpr std::size_t alignment() noexcept {
+    return alignof(decltype(storage_));
+  }
+};
+
+/// Asserts that a box of the given size and alignment is allocated inplace
+/// by a strict function, the sizes are shown by the template arguments
+/// of this type when the assertion fails.
+template <bool IsStrict, std::size_t Size, std::size_t Capacity,
+          std::size_t Alignment, std::size_t CapacityAlignment,
+          bool IsInplaceAllowed>
+struct assert_fits_inplace : std::true_type {
+  static_assert(!IsStrict || (Size <= Capacity),
+                "The callable is larger than the capacity of the strict "
+                "function, see the Size and Capacity template arguments "
+                "of assert_fits_inplace!");
+  static_assert(!IsStrict || (Alignment <= CapacityAlignment),
+                "The callable is aligned stricter than the capacity of the "
+                "strict function, see the Alignment and CapacityAlignment "
+                "template arguments of assert_fits_inplace!");
+  static_assert(!IsStrict || IsInplaceAllowed,
+                "The callable isn't allowed to be allocated inplace by the "
+                "strict function, since its move constructor may throw or "
+                "it isn't trivially relocatable!");
 };
 
 /// An owning erasure
@@ -1133,15 +3044,36 @@ class erasure : internal_capacity_holder<typename Config::capacity> {
   template <std::size_t, typename, typename...>
   friend class operator_impl;
 
-  using vtable_t = tables::vtable<Property>;
+  using vtable_t = tables::vtable<Property, Config::layout, Config::inplace,
+                                  Config::sharing, Config::is_strict>;
+
+  template <typename T, typename Allocator>
+  using box_t = box<Config::is_copyable, T, Allocator>;
 
   vtable_t vtable_;
 
+  /// Fails to compile when the given box isn't allocated inplace
+  /// by a strict function
+  template <typename Box>
+  static constexpr bool assert_inplace() noexcept {
+    return assert_fits_inplace<
+        Config::is_strict, sizeof(Box), capacity(), alignof(Box), alignment(),
+        (Config::inplace == inplace_rule::any) ||
+            ((Config::inplace == inplace_rule::nothrow_movable) &&
+             std::is_nothrow_move_constructible<Box>::value) ||
+            ((Config::inplace == inplace_rule::trivially_relocatable) &&
+             tables::is_trivially_relocatable_inplace<Box>::value)>::value;
+  }
+
 public:
   /// Returns the capacity of this erasure
   static constexpr std::size_t capacity() noexcept {
     return internal_capacity_holder<typename Config::capacity>::capacity();
   }
+  /// Returns the alignment of the capacity of this erasure
+  static constexpr std::size_t alignment() noexcept {
+    return internal_capacity_holder<typename Config::capacity>::alignment();
+  }
 
   FU2_DETAIL_CXX14_CONSTEXPR erasure() noexcept {
     vtable_.set_empty();
@@ -1152,73 +3084,91 @@ public:
   }
 
   FU2_DETAIL_CXX14_CONSTEXPR
-  erasure(erasure&& right) noexcept(Property::is_strong_exception_guaranteed) {
-    right.vtable_.move(vtable_, right.opaque_ptr(), right.capacity(),
-                       this->opaque_ptr(), capacity());
+  erasure(erasure&& right) noexcept(Property::is_strong_exception_guaranteed ||
+                                    Config::is_nothrow_movable) {
+    right.vtable_.template relocate<capacity(), alignment()>(
+        vtable_, right.opaque_ptr(), this->opaque_ptr());
   }
 
   FU2_DETAIL_CXX14_CONSTEXPR erasure(erasure const& right) {
-    right.vtable_.copy(vtable_, right.opaque_ptr(), right.capacity(),
-                       this->opaque_ptr(), capacity());
+    right.vtable_.template copy<capacity(), alignment()>(
+        vtable_, right.opaque_ptr(), this->opaque_ptr());
   }
 
   template <typename OtherConfig>
   FU2_DETAIL_CXX14_CONSTEXPR
   erasure(erasure<true, OtherConfig, Property> right) noexcept(
       Property::is_strong_exception_guaranteed) {
-    right.vtable_.move(vtable_, right.opaque_ptr(), right.capacity(),
-                       this->opaque_ptr(), capacity());
+    right.vtable_.move(vtable_, right.opaque_ptr(), this->opaque_ptr(),
+                       capacity(), alignment());
   }
 
   template <typename T, typename Allocator = std::allocator<std::decay_t<T>>>
   FU2_DETAIL_CXX14_CONSTEXPR erasure(std::false_type /*use_bool_op*/,
                                      T&& callable,
                                      Allocator&& allocator_ = Allocator{}) {
+    static_assert(
+        assert_inplace<box_t<std::decay_t<T>, std::decay_t<Allocator>>>(),
+        "The callable has to be allocated inplace!");
     vtable_t::init(vtable_,
-                   type_erasure::make_box(
+                   type_erasure::make_erased_box(
                        std::integral_constant<bool, Config::is_copyable>{},
                        std::forward<T>(callable),
                        std::forward<Allocator>(allocator_)),
-                   this->opaque_ptr(), capacity());
+                   this->opaque_ptr(), capacity(), alignment());
   }
-  template <typename T, typename Allocator = std::allocator<std::decay_t<T>>>
-  FU2_DETAIL_CXX14_CONSTEXPR erasure(std::true_type /*use_bool_op*/,
+  template <typename T, typename Allocator, typename... Args>
+  FU2_DETAIL_CXX14_CONSTEXPR erasure(in_place_type_t<T>,
+                                     Allocator const& allocator_,
+                                     Args&&... args) {
+    static_assert(assert_inplace<box_t<T, Allocator>>(),
+                  "The callable has to be allocated inplace!");
+    vtable_t::template init_in_place<box_t<T, Allocator>>(
+        vtable_, this->opaque_ptr(), capacity(), alignment(), allocator_,
+        std::forward<Args>(args)...);
+  }
+
+  template <typename T, typename Allocator = std::allocator<std::decay_t<T>>>
+  FU2_DETAIL_CXX14_CONSTEXPR erasure(std::true_type /*use_bool_op*/,
                                      T&& callable,
                                      Allocator&& allocator_ = Allocator{}) {
+    static_assert(
+        assert_inplace<box_t<std::decay_t<T>, std::decay_t<Allocator>>>(),
+        "The callable has to be allocated inplace!");
     if (!!callable) {
       vtable_t::init(vtable_,
-                     type_erasure::make_box(
+                     type_erasure::make_erased_box(
                          std::integral_constant<bool, Config::is_copyable>{},
                          std::forward<T>(callable),
                          std::forward<Allocator>(allocator_)),
-                     this->opaque_ptr(), capacity());
+                     this->opaque_ptr(), capacity(), alignment());
     } else {
       vtable_.set_empty();
     }
   }
 
   ~erasure() {
-    vtable_.weak_destroy(this->opaque_ptr(), capacity());
+    vtable_.weak_destroy(this->opaque_ptr());
   }
 
   FU2_DETAIL_CXX14_CONSTEXPR erasure&
   operator=(std::nullptr_t) noexcept(Property::is_strong_exception_guaranteed) {
-    vtable_.destroy(this->opaque_ptr(), capacity());
+    vtable_.destroy(this->opaque_ptr());
     return *this;
   }
 
   FU2_DETAIL_CXX14_CONSTEXPR erasure& operator=(erasure&& right) noexcept(
-      Property::is_strong_exception_guaranteed) {
-    vtable_.weak_destroy(this->opaque_ptr(), capacity());
-    right.vtable_.move(vtable_, right.opaque_ptr(), right.capacity(),
-                       this->opaque_ptr(), capacity());
+      Property::is_strong_exception_guaranteed || Config::is_nothrow_movable) {
+    vtable_.weak_destroy(this->opaque_ptr());
+    right.vtable_.template relocate<capacity(), alignment()>(
+        vtable_, right.opaque_ptr(), this->opaque_ptr());
     return *this;
   }
 
   FU2_DETAIL_CXX14_CONSTEXPR erasure& operator=(erasure const& right) {
-    vtable_.weak_destroy(this->opaque_ptr(), capacity());
-    right.vtable_.copy(vtable_, right.opaque_ptr(), right.capacity(),
-                       this->opaque_ptr(), capacity());
+    vtable_.weak_destroy(this->opaque_ptr());
+    right.vtable_.template copy<capacity(), alignment()>(
+        vtable_, right.opaque_ptr(), this->opaque_ptr());
     return *this;
   }
 
@@ -1226,22 +3176,24 @@ public:
   FU2_DETAIL_CXX14_CONSTEXPR erasure&
   operator=(erasure<true, OtherConfig, Property> right) noexcept(
       Property::is_strong_exception_guaranteed) {
-    vtable_.weak_destroy(this->opaque_ptr(), capacity());
-    right.vtable_.move(vtable_, right.opaque_ptr(), right.capacity(),
-                       this->opaque_ptr(), capacity());
+    vtable_.weak_destroy(this->opaque_ptr());
+    right.vtable_.move(vtable_, right.opaque_ptr(), this->opaque_ptr(),
+                       capacity(), alignment());
     return *this;
   }
 
   template <typename T, typename Allocator = std::allocator<std::decay_t<T>>>
   void assign(std::false_type /*use_bool_op*/, T&& callable,
               Allocator&& allocator_ = {}) {
-    vtable_.weak_destroy(this->opaque_ptr(), capacity());
-    vtable_t::init(vtable_,
-                   type_erasure::make_box(
-                       std::integral_constant<bool, Config::is_copyable>{},
-                       std::forward<T>(callable),
-                       std::forward<Allocator>(allocator_)),
-                   this->opaque_ptr(), capacity());
+    static_assert(
+        assert_inplace<box_t<std::decay_t<T>, std::decay_t<Allocator>>>(),
+        "The callable has to be allocated inplace!");
+    vtable_t::assign(vtable_,
+                     type_erasure::make_erased_box(
+                         std::integral_constant<bool, Config::is_copyable>{},
+                         std::forward<T>(callable),
+                         std::forward<Allocator>(allocator_)),
+                     this->opaque_ptr(), capacity(), alignment());
   }
 
   template <typename T, typename Allocator = std::allocator<std::decay_t<T>>>
@@ -1255,24 +3207,252 @@ public:
     }
   }
 
+  template <typename T, typename Allocator, typename... Args>
+  T& emplace(in_place_type_t<T>, Allocator const& allocator_,
+             Args&&... args) {
+    static_assert(assert_inplace<box_t<T, Allocator>>(),
+                  "The callable has to be allocated inplace!");
+    return vtable_t::template emplace<box_t<T, Allocator>>(
+               vtable_, this->opaque_ptr(), capacity(), alignment(),
+               allocator_, std::forward<Args>(args)...)
+        ->value_;
+  }
+
+  /// Reserves a heap block of at least the given size
+  void reserve(std::size_t size) {
+    vtable_.reserve(this->opaque_ptr(), size);
+  }
+
+  /// Returns true when the erasure may be relocated bitwise
+  constexpr bool is_trivially_relocatable() const noexcept {
+    return vtable_.is_trivially_relocatable();
+  }
+
   /// Returns true when the erasure doesn't hold any erased object
   constexpr bool empty() const noexcept {
     return vtable_.empty();
   }
 
+  /// Returns the erased object if it is of type T and was stored through
+  /// an allocator of the given type, or a null pointer otherwise
+  template <typename T, typename Allocator>
+  T* target() {
+    return vtable_.template target<box_t<T, Allocator>>(this->opaque_ptr());
+  }
+  template <typename T, typename Allocator>
+  T const* target() const noexcept {
+    return vtable_.template target<box_t<T, Allocator>>(this->opaque_ptr());
+  }
+
+  /// Returns the thunk of the signature at the given index
+  template <std::size_t Index>
+  constexpr auto thunk() const noexcept {
+    return vtable_.template thunk<Index>();
+  }
+  /// Returns the context which is passed to the thunks
+  constexpr void* context() const noexcept {
+    return invocation_table::context_of(this->opaque_ptr());
+  }
+
   /// Invoke the function of the erasure at the given index
   ///
   /// We define this out of class to be able to forward the qualified
   /// erasure correctly.
   template <std::size_t Index, typename Erasure, typename... Args>
   static constexpr decltype(auto) invoke(Erasure&& erasure, Args&&... args) {
-    auto const capacity = erasure.capacity();
     return erasure.vtable_.template invoke<Index>(
-        std::forward<Erasure>(erasure).opaque_ptr(), capacity,
+        std::forward<Erasure>(erasure).opaque_ptr(),
         std::forward<Args>(args)...);
   }
 };
 
+/// An owning erasure which only stores a pointer to a heap block,
+/// that holds the table in front of the erased object.
+template <typename Config, typename Property>
+class thin_erasure {
+  template <typename, typename>
+  friend class thin_erasure;
+  template <std::size_t, typename, typename...>
+  friend class operator_impl;
+
+  using vtable_t = tables::thin_vtable<Property>;
+
+  template <typename T, typename Allocator>
+  using box_t = box<Config::is_copyable, T, Allocator>;
+
+  data_accessor accessor_;
+
+public:
+  constexpr thin_erasure() noexcept : accessor_(nullptr) {
+  }
+
+  constexpr thin_erasure(std::nullptr_t) noexcept : accessor_(nullptr) {
+  }
+
+  FU2_DETAIL_CXX14_CONSTEXPR thin_erasure(thin_erasure&& right) noexcept
+      : accessor_(right.accessor_) {
+    right.accessor_.ptr_ = nullptr;
+  }
+
+  FU2_DETAIL_CXX14_CONSTEXPR thin_erasure(thin_erasure const& right)
+      : accessor_(nullptr) {
+    vtable_t::copy(&right.accessor_, &accessor_);
+  }
+
+  template <typename OtherConfig>
+  FU2_DETAIL_CXX14_CONSTEXPR
+  thin_erasure(thin_erasure<OtherConfig, Property> right) noexcept
+      : accessor_(right.accessor_) {
+    right.accessor_.ptr_ = nullptr;
+  }
+
+  template <typename T, typename Allocator = std::allocator<std::decay_t<T>>>
+  FU2_DETAIL_CXX14_CONSTEXPR thin_erasure(std::false_type /*use_bool_op*/,
+                                          T&& callable,
+                                          Allocator&& allocator_ = Allocator{})
+      : accessor_(nullptr) {
+    vtable_t::init(type_erasure::make_box(
+                       std::integral_constant<bool, Config::is_copyable>{},
+                       std::forward<T>(callable),
+                       std::forward<Allocator>(allocator_)),
+                   &accessor_);
+  }
+  template <typename T, typename Allocator, typename... Args>
+  FU2_DETAIL_CXX14_CONSTEXPR thin_erasure(in_place_type_t<T>,
+                                          Allocator const& allocator_,
+                                          Args&&... args)
+      : accessor_(nullptr) {
+    vtable_t::template init_in_place<box_t<T, Allocator>>(
+        &accessor_, allocator_, std::forward<Args>(args)...);
+  }
+
+  template <typename T, typename Allocator = std::allocator<std::decay_t<T>>>
+  FU2_DETAIL_CXX14_CONSTEXPR thin_erasure(std::true_type /*use_bool_op*/,
+                                          T&& callable,
+                                          Allocator&& allocator_ = Allocator{})
+      : accessor_(nullptr) {
+    if (!!callable) {
+      vtable_t::init(type_erasure::make_box(
+                         std::integral_constant<bool, Config::is_copyable>{},
+                         std::forward<T>(callable),
+                         std::forward<Allocator>(allocator_)),
+                     &accessor_);
+    }
+  }
+
+  ~thin_erasure() {
+    vtable_t::destroy(&accessor_);
+  }
+
+  FU2_DETAIL_CXX14_CONSTEXPR thin_erasure&
+  operator=(std::nullptr_t) noexcept(Property::is_strong_exception_guaranteed) {
+    vtable_t::destroy(&accessor_);
+    return *this;
+  }
+
+  FU2_DETAIL_CXX14_CONSTEXPR thin_erasure&
+  operator=(thin_erasure&& right) noexcept {
+    if (this != &right) {
+      vtable_t::destroy(&accessor_);
+      accessor_ = right.accessor_;
+      right.accessor_.ptr_ = nullptr;
+    }
+    return *this;
+  }
+
+  FU2_DETAIL_CXX14_CONSTEXPR thin_erasure&
+  operator=(thin_erasure const& right) {
+    if (this != &right) {
+      vtable_t::destroy(&accessor_);
+      vtable_t::copy(&right.accessor_, &accessor_);
+    }
+    return *this;
+  }
+
+  template <typename OtherConfig>
+  FU2_DETAIL_CXX14_CONSTEXPR thin_erasure&
+  operator=(thin_erasure<OtherConfig, Property> right) noexcept {
+    vtable_t::destroy(&accessor_);
+    accessor_ = right.accessor_;
+    right.accessor_.ptr_ = nullptr;
+    return *this;
+  }
+
+  template <typename T, typename Allocator = std::allocator<std::decay_t<T>>>
+  void assign(std::false_type /*use_bool_op*/, T&& callable,
+              Allocator&& allocator_ = {}) {
+    vtable_t::destroy(&accessor_);
+    vtable_t::init(type_erasure::make_box(
+                       std::integral_constant<bool, Config::is_copyable>{},
+                       std::forward<T>(callable),
+                       std::forward<Allocator>(allocator_)),
+                   &accessor_);
+  }
+
+  template <typename T, typename Allocator = std::allocator<std::decay_t<T>>>
+  void assign(std::true_type /*use_bool_op*/, T&& callable,
+              Allocator&& allocator_ = {}) {
+    if (!!callable) {
+      assign(std::false_type{}, std::forward<T>(callable),
+             std::forward<Allocator>(allocator_));
+    } else {
+      operator=(nullptr);
+    }
+  }
+
+  template <typename T, typename Allocator, typename... Args>
+  T& emplace(in_place_type_t<T>, Allocator const& allocator_,
+             Args&&... args) {
+    vtable_t::destroy(&accessor_);
+    return vtable_t::template init_in_place<box_t<T, Allocator>>(
+               &accessor_, allocator_, std::forward<Args>(args)...)
+        ->value_;
+  }
+
+  /// Every object is allocated inside its own heap block,
+  /// which is why there is nothing to reserve.
+  void reserve(std::size_t /*size*/) noexcept {
+  }
+
+  /// Returns true when the erasure may be relocated bitwise
+  constexpr bool is_trivially_relocatable() const noexcept {
+    return true;
+  }
+
+  /// Returns true when the erasure doesn't hold any erased object
+  constexpr bool empty() const noexcept {
+    return accessor_.ptr_ == nullptr;
+  }
+
+  /// Returns the erased object if it is of type T and was stored through
+  /// an allocator of the given type, or a null pointer otherwise
+  template <typename T, typename Allocator>
+  T* target() noexcept {
+    return vtable_t::template target<box_t<T, Allocator>>(&accessor_);
+  }
+  template <typename T, typename Allocator>
+  T const* target() const noexcept {
+    return vtable_t::template target<box_t<T, Allocator>>(&accessor_);
+  }
+
+  /// Returns the thunk of the signature at the given index
+  template <std::size_t Index>
+  auto thunk() const noexcept {
+    return vtable_t::template thunk<Index>(&accessor_);
+  }
+  /// Returns the context which is passed to the thunks
+  constexpr void* context() const noexcept {
+    return invocation_table::context_of(&accessor_);
+  }
+
+  /// Invoke the function of the erasure at the given index
+  template <std::size_t Index, typename Erasure, typename... Args>
+  static constexpr decltype(auto) invoke(Erasure&& erasure, Args&&... args) {
+    return vtable_t::template invoke<Index>(&(erasure.accessor_),
+                                            std::forward<Args>(args)...);
+  }
+};
+
 // A non owning erasure
 template </*bool IsOwning = false, */ typename Config, bool IsThrowing,
           bool HasStrongExceptGuarantee, typename... Args>
@@ -1380,10 +3560,26 @@ public:
     return view_.ptr_ == nullptr;
   }
 
+  /// Returns true when the erasure may be relocated bitwise
+  constexpr bool is_trivially_relocatable() const noexcept {
+    return true;
+  }
+
+  /// Returns the thunk of the signature at the given index
+  template <std::size_t Index>
+  constexpr auto thunk() const noexcept {
+    return invoke_table_t::template fetch<Index>(invoke_table_);
+  }
+  /// Returns the context which is passed to the thunks
+  constexpr void* context() const noexcept {
+    return invocation_table::context_of(&view_);
+  }
+
   template <std::size_t Index, typename Erasure, typename... T>
   static constexpr decltype(auto) invoke(Erasure&& erasure, T&&... args) {
     auto thunk = invoke_table_t::template fetch<Index>(erasure.invoke_table_);
-    return thunk(&(erasure.view_), 0UL, std::forward<T>(args)...);
+    return thunk(invocation_table::context_of(&(erasure.view_)),
+                 std::forward<T>(args)...);
   }
 };
 } // namespace type_erasure
@@ -1505,14 +3701,176 @@ template <typename LeftConfig, typename RightConfig>
 using enable_if_owning_correct_t =
     std::enable_if_t<is_owning_correct<LeftConfig, RightConfig>::value>;
 
+/// SFINAES out if the given function2 stores its tables differently
+/// or allocates or shares objects under different rules,
+/// which is only relevant for owning functions.
+/// Strict functions additionally require the same capacity,
+/// since they can't fall back to the heap.
+///
+/// Such a function isn't converted by taking over its erased object,
+/// instead it is wrapped as any other callable.
+template <typename LeftConfig, typename RightConfig>
+using enable_if_layout_correct_t = std::enable_if_t<(
+    !LeftConfig::is_owning ||
+    ((LeftConfig::layout == RightConfig::layout) &&
+     (LeftConfig::inplace == RightConfig::inplace) &&
+     (LeftConfig::sharing == RightConfig::sharing) &&
+     (LeftConfig::is_strict == RightConfig::is_strict) &&
+     (!LeftConfig::is_strict ||
+      std::is_same<typename LeftConfig::capacity,
+                   typename RightConfig::capacity>::value)))>;
+
+namespace composition {
+/// Invokes the stage at the given index with the given arguments and all
+/// following stages with the result of their previous stage
+template <std::size_t Index, std::size_t Last>
+struct chain {
+  template <typename Stages, typename... Args>
+  static constexpr auto call(Stages& stages, Args&&... args)
+      -> decltype(chain<Index + 1U, Last>::call(
+          stages, invocation::invoke(std::get<Index>(stages),
+                                     std::forward<Args>(args)...))) {
+    return chain<Index + 1U, Last>::call(
+        stages, invocation::invoke(std::get<Index>(stages),
+                                   std::forward<Args>(args)...));
+  }
+};
+template <std::size_t Last>
+struct chain<Last, Last> {
+  template <typename Stages, typename... Args>
+  static constexpr auto call(Stages& stages, Args&&... args)
+      -> decltype(invocation::invoke(std::get<Last>(stages),
+                                     std::forward<Args>(args)...)) {
+    return invocation::invoke(std::get<Last>(stages),
+                              std::forward<Args>(args)...);
+  }
+};
+
+template <typename... T>
+constexpr auto compose(T&&... callables);
+
+/// A callable which holds a flat sequence of stages, where every stage is
+/// invoked with the result of its previous stage.
+///
+/// Stages keep their concrete type so they can be inlined, a function
+/// wrapper which is used as stage is invoked through its own thunk.
+template <typename... Stages>
+class composed {
+  static_assert(sizeof...(Stages) > 0U, "At least one stage is required!");
+
+  template <typename...>
+  friend class composed;
+
+  using stages_t = std::tuple<Stages...>;
+  using chain_t = chain<0U, sizeof...(Stages) - 1U>;
+
+  stages_t stages_;
+
+public:
+  explicit constexpr composed(stages_t stages) : stages_(std::move(stages)) {
+  }
+
+  /// Returns the stages of the composition
+  constexpr stages_t const& stages() const& noexcept {
+    return stages_;
+  }
+  FU2_DETAIL_CXX14_CONSTEXPR stages_t&& stages() && noexcept {
+    return std::move(stages_);
+  }
+
+  /// Returns a composition which invokes the given callable with the
+  /// result of this composition as its last stage
+  template <typename T>
+  constexpr auto then(T&& callable) const& {
+    return composition::compose(*this, std::forward<T>(callable));
+  }
+  /// Returns a composition which invokes the given callable with the
+  /// result of this composition as its last stage
+  template <typename T>
+  FU2_DETAIL_CXX14_CONSTEXPR auto then(T&& callable) && {
+    return composition::compose(std::move(*this), std::forward<T>(callable));
+  }
+
+  template <typename... Args>
+  constexpr auto operator()(Args&&... args)
+      -> decltype(chain_t::call(std::declval<stages_t&>(),
+                                std::forward<Args>(args)...)) {
+    return chain_t::call(stages_, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  constexpr auto operator()(Args&&... args) const
+      -> decltype(chain_t::call(std::declval<stages_t const&>(),
+                                std::forward<Args>(args)...)) {
+    return chain_t::call(stages_, std::forward<Args>(args)...);
+  }
+};
+
+/// Returns the stages which the given callable contributes to a
+/// composition, the stages of nested compositions are flattened.
+template <typename T>
+constexpr auto stages_of(T&& callable) {
+  return std::tuple<std::decay_t<T>>(std::forward<T>(callable));
+}
+template <typename... Stages>
+constexpr auto stages_of(composed<Stages...> const& callable) {
+  return callable.stages();
+}
+template <typename... Stages>
+constexpr auto stages_of(composed<Stages...>& callable) {
+  return callable.stages();
+}
+template <typename... Stages>
+constexpr auto stages_of(composed<Stages...>&& callable) {
+  return std::move(callable).stages();
+}
+
+template <typename Stages>
+struct composed_of;
+template <typename... Stages>
+struct composed_of<std::tuple<Stages...>> {
+  using type = composed<Stages...>;
+};
+
+template <typename... T>
+constexpr auto compose(T&&... callables) {
+  auto stages = std::tuple_cat(stages_of(std::forward<T>(callables))...);
+  return typename composed_of<decltype(stages)>::type(std::move(stages));
+}
+} // namespace composition
+
+/// Provides the signatures of a function where all batch signatures are
+/// expanded, together with the property of its erasure and the base
+/// which provides its call operators.
+template <typename Function, typename Signatures>
+struct expanded_function;
+template <typename Config, bool IsThrowing, bool HasStrongExceptGuarantee,
+          typename... Args, typename... Signatures>
+struct expanded_function<
+    function<Config, property<IsThrowing, HasStrongExceptGuarantee, Args...>>,
+    identity<Signatures...>> {
+  using signatures_t = identity<Signatures...>;
+  using property_t =
+      property<IsThrowing, HasStrongExceptGuarantee, Signatures...>;
+  using operator_t = type_erasure::invocation_table::operator_impl<
+      0U,
+      function<Config,
+               property<IsThrowing, HasStrongExceptGuarantee, Args...>>,
+      Signatures...>;
+  using probe_t =
+      type_erasure::invocation_table::signature_probe<Signatures...>;
+};
+template <typename Config, bool IsThrowing, bool HasStrongExceptGuarantee,
+          typename... Args>
+using expanded_function_t = expanded_function<
+    function<Config, property<IsThrowing, HasStrongExceptGuarantee, Args...>>,
+    typename type_erasure::invocation_table::expand_batches<identity<>,
+                                                            Args...>::type>;
+
 template <typename Config, bool IsThrowing, bool HasStrongExceptGuarantee,
           typename... Args>
 class function<Config, property<IsThrowing, HasStrongExceptGuarantee, Args...>>
-    : type_erasure::invocation_table::operator_impl<
-          0U,
-          function<Config,
-                   property<IsThrowing, HasStrongExceptGuarantee, Args...>>,
-          Args...> {
+    : expanded_function_t<Config, IsThrowing, HasStrongExceptGuarantee,
+                          Args...>::operator_t {
 
   template <typename, typename>
   friend class function;
@@ -1520,9 +3878,65 @@ class function<Config, property<IsThrowing, HasStrongExceptGuarantee, Args...>>
   template <std::size_t, typename, typename...>
   friend class type_erasure::invocation_table::operator_impl;
 
+  template <typename LConfig, typename LProperty>
+  friend function<LConfig, LProperty>*
+  relocate_n(function<LConfig, LProperty>* first, std::size_t count,
+             function<LConfig, LProperty>* dest);
+
   using property_t = property<IsThrowing, HasStrongExceptGuarantee, Args...>;
-  using erasure_t =
-      type_erasure::erasure<Config::is_owning, Config, property_t>;
+  using expanded_t = expanded_function_t<Config, IsThrowing,
+                                         HasStrongExceptGuarantee, Args...>;
+  using erasure_t = std::conditional_t<
+      Config::is_owning && (Config::layout == table_layout::thin),
+      type_erasure::thin_erasure<Config, typename expanded_t::property_t>,
+      type_erasure::erasure<Config::is_owning, Config,
+                            typename expanded_t::property_t>>;
+
+  template <typename Element>
+  using batch_index_of_t = type_erasure::invocation_table::batch_index_of<
+      Element, 0U, typename expanded_t::signatures_t>;
+
+  template <typename Batch, bool IsVoid>
+  using enable_if_batch_t = std::enable_if_t<
+      std::is_void<typename Batch::trait::result_type>::value == IsVoid>;
+
+  template <typename Signature>
+  using signature_index_of_t =
+      type_erasure::invocation_table::signature_index_of<
+          Signature, 0U, typename expanded_t::signatures_t>;
+
+  template <typename Signature>
+  using raw_thunk_t =
+      type_erasure::invocation_table::raw_thunk_of<Signature>;
+
+  template <typename Signature>
+  using buffer_layout_t = type_erasure::invocation_table::packed_layout<
+      typename type_erasure::invocation_table::function_trait<
+          Signature>::arguments>;
+
+  template <typename Signature>
+  using is_const_signature = std::is_const<std::remove_reference_t<
+      typename type_erasure::invocation_table::function_trait<
+          Signature>::template callable<int>>>;
+
+  /// Deduces to a true type if the signature would copy a shared callable
+  /// on write inside a noexcept thunk, where a throwing copy terminates.
+  template <typename Signature>
+  using is_noexcept_copy_on_write = std::integral_constant<
+      bool, Config::is_owning && Config::is_copyable &&
+                (Config::sharing != sharing_rule::none) &&
+                !is_const_signature<Signature>::value &&
+                type_erasure::invocation_table::function_trait<
+                    Signature>::is_noexcept::value>;
+
+  static_assert(
+      std::is_same<std::integer_sequence<
+                       bool, false, is_noexcept_copy_on_write<Args>::value...>,
+                   std::integer_sequence<
+                       bool, is_noexcept_copy_on_write<Args>::value...,
+                       false>>::value,
+      "Shared functions copy their callable on write, which may throw, "
+      "therefore noexcept signatures have to be const qualified!");
 
   template <typename T>
   using enable_if_can_accept_all_t =
@@ -1534,7 +3948,8 @@ class function<Config, property<IsThrowing, HasStrongExceptGuarantee, Args...>>
   struct is_convertible_to_this<
       function<RightConfig, property_t>,
       void_t<enable_if_copyable_correct_t<Config, RightConfig>,
-             enable_if_owning_correct_t<Config, RightConfig>>>
+             enable_if_owning_correct_t<Config, RightConfig>,
+             enable_if_layout_correct_t<Config, RightConfig>>>
       : std::true_type {};
 
   template <typename T>
@@ -1569,7 +3984,8 @@ public:
   template <typename RightConfig,
             std::enable_if_t<RightConfig::is_copyable>* = nullptr,
             enable_if_copyable_correct_t<Config, RightConfig>* = nullptr,
-            enable_if_owning_correct_t<Config, RightConfig>* = nullptr>
+            enable_if_owning_correct_t<Config, RightConfig>* = nullptr,
+            enable_if_layout_correct_t<Config, RightConfig>* = nullptr>
   FU2_DETAIL_CXX14_CONSTEXPR
   function(function<RightConfig, property_t> const& right)
       : erasure_(right.erasure_) {
@@ -1578,7 +3994,8 @@ public:
   /// Move construction from another function
   template <typename RightConfig,
             enable_if_copyable_correct_t<Config, RightConfig>* = nullptr,
-            enable_if_owning_correct_t<Config, RightConfig>* = nullptr>
+            enable_if_owning_correct_t<Config, RightConfig>* = nullptr,
+            enable_if_layout_correct_t<Config, RightConfig>* = nullptr>
   FU2_DETAIL_CXX14_CONSTEXPR function(function<RightConfig, property_t>&& right)
       : erasure_(std::move(right.erasure_)) {
   }
@@ -1603,6 +4020,18 @@ public:
                  std::forward<Allocator>(allocator_)) {
   }
 
+  /// Constructs a callable of type T from the given arguments
+  /// directly inside the storage of the function
+  template <typename T, typename... CtorArgs,
+            enable_if_can_accept_all_t<T>* = nullptr,
+            enable_if_owning_t<T>* = nullptr,
+            assert_wrong_copy_assign_t<T>* = nullptr,
+            assert_no_strong_except_guarantee_t<T>* = nullptr>
+  FU2_DETAIL_CXX14_CONSTEXPR explicit function(in_place_type_t<T> tag,
+                                               CtorArgs&&... args)
+      : erasure_(tag, std::allocator<T>{}, std::forward<CtorArgs>(args)...) {
+  }
+
   /// Empty constructs the function
   FU2_DETAIL_CXX14_CONSTEXPR function(std::nullptr_t np) : erasure_(np) {
   }
@@ -1614,7 +4043,8 @@ public:
   template <typename RightConfig,
             std::enable_if_t<RightConfig::is_copyable>* = nullptr,
             enable_if_copyable_correct_t<Config, RightConfig>* = nullptr,
-            enable_if_owning_correct_t<Config, RightConfig>* = nullptr>
+            enable_if_owning_correct_t<Config, RightConfig>* = nullptr,
+            enable_if_layout_correct_t<Config, RightConfig>* = nullptr>
   function& operator=(function<RightConfig, property_t> const& right) {
     erasure_ = right.erasure_;
     return *this;
@@ -1623,7 +4053,8 @@ public:
   /// Move assigning from another function
   template <typename RightConfig,
             enable_if_copyable_correct_t<Config, RightConfig>* = nullptr,
-            enable_if_owning_correct_t<Config, RightConfig>* = nullptr>
+            enable_if_owning_correct_t<Config, RightConfig>* = nullptr,
+            enable_if_layout_correct_t<Config, RightConfig>* = nullptr>
   function& operator=(function<RightConfig, property_t>&& right) {
     erasure_ = std::move(right.erasure_);
     return *this;
@@ -1656,6 +4087,146 @@ public:
     return !empty();
   }
 
+  /// Returns a pointer to the callable if it is of type T and was stored
+  /// through an allocator of the given type, or a null pointer otherwise.
+  ///
+  /// The type is checked through a single comparison of addresses which
+  /// doesn't require RTTI. Empty allocators are interchangeable here,
+  /// a callable stored through any of them is returned for each of them.
+  /// A callable held by a shared function is copied before it is returned
+  /// as mutable object while it is shared.
+  template <typename T, typename Allocator = std::allocator<T>,
+            enable_if_owning_t<T>* = nullptr>
+  T* target() {
+    return erasure_.template target<T, Allocator>();
+  }
+  /// Returns a pointer to the callable if it is of type T and was stored
+  /// through an allocator of the given type, or a null pointer otherwise.
+  template <typename T, typename Allocator = std::allocator<T>,
+            enable_if_owning_t<T>* = nullptr>
+  T const* target() const noexcept {
+    return erasure_.template target<T, Allocator>();
+  }
+
+  /// Invokes the callable with every element of the given range through
+  /// a single call of its erased thunk, which requires a fu2::batch
+  /// signature that is invoked with elements of the given type.
+  template <typename Element, typename Batch = batch_index_of_t<Element>,
+            enable_if_batch_t<Batch, true>* = nullptr>
+  void invoke_batch(Element const* first, std::size_t count) {
+    erasure_t::template invoke<Batch::value>(erasure_, first, count, nullptr);
+  }
+  /// Invokes the callable with every element of the given range through
+  /// a single call of its erased thunk, and stores the result of every
+  /// invocation into the given output range.
+  template <typename Element, typename Batch = batch_index_of_t<Element>,
+            enable_if_batch_t<Batch, false>* = nullptr>
+  void invoke_batch(Element const* first, std::size_t count,
+                    typename Batch::trait::result_type* out) {
+    erasure_t::template invoke<Batch::value>(erasure_, first, count, out);
+  }
+  /// Invokes the callable with every element of the given range through
+  /// a single call of its erased thunk, which requires a fu2::batch
+  /// signature that is invoked with elements of the given type.
+  template <typename Element, typename Batch = batch_index_of_t<Element>,
+            enable_if_batch_t<Batch, true>* = nullptr>
+  void invoke_batch(Element const* first, std::size_t count) const {
+    static_assert(Batch::trait::is_const::value,
+                  "The batch signature isn't const qualified!");
+    erasure_t::template invoke<Batch::value>(erasure_, first, count, nullptr);
+  }
+  /// Invokes the callable with every element of the given range through
+  /// a single call of its erased thunk, and stores the result of every
+  /// invocation into the given output range.
+  template <typename Element, typename Batch = batch_index_of_t<Element>,
+            enable_if_batch_t<Batch, false>* = nullptr>
+  void invoke_batch(Element const* first, std::size_t count,
+                    typename Batch::trait::result_type* out) const {
+    static_assert(Batch::trait::is_const::value,
+                  "The batch signature isn't const qualified!");
+    erasure_t::template invoke<Batch::value>(erasure_, first, count, out);
+  }
+
+  /// Returns the thunk of the given signature together with the context
+  /// which it is invoked with.
+  ///
+  /// Invoking the thunk with the context as first argument invokes the
+  /// callable through a single indirect call, which makes the pair usable
+  /// as callback of C interfaces, or to load the thunk only once in front
+  /// of a loop. The pair is valid until the function is modified, moved
+  /// or destroyed.
+  ///
+  /// Arguments which aren't trivially copyable are passed to the thunk
+  /// as rvalue reference, see fu2::raw_function for details.
+  template <typename Signature =
+                std::tuple_element_t<0U, std::tuple<Args...>>,
+            typename Index = signature_index_of_t<Signature>>
+  raw_thunk_t<Signature> raw() noexcept {
+    return {erasure_.template thunk<Index::value>(), erasure_.context()};
+  }
+  /// Returns the thunk of the given const signature together with the
+  /// context which it is invoked with.
+  template <typename Signature =
+                std::tuple_element_t<0U, std::tuple<Args...>>,
+            typename Index = signature_index_of_t<Signature>>
+  raw_thunk_t<Signature> raw() const noexcept {
+    static_assert(is_const_signature<Signature>::value,
+                  "The signature isn't const qualified!");
+    return {erasure_.template thunk<Index::value>(), erasure_.context()};
+  }
+
+  /// Invokes the callable with the arguments of the given signature,
+  /// which are loaded from a buffer that is laid out as described by
+  /// fu2::buffer_layout, without decoding them into a tuple first.
+  ///
+  /// The buffer of the given size is required to hold all arguments,
+  /// which is asserted.
+  template <typename Signature =
+                std::tuple_element_t<0U, std::tuple<Args...>>,
+            typename Index = signature_index_of_t<Signature>>
+  decltype(auto) invoke_from_buffer(void const* data, std::size_t size) {
+    assert((size >= buffer_layout_t<Signature>::size) &&
+           "The buffer is too small to hold all arguments!");
+    (void)size;
+    return buffer_layout_t<Signature>::load(
+        data, [&](auto&&... args) -> decltype(auto) {
+          return erasure_t::template invoke<Index::value>(
+              erasure_, std::forward<decltype(args)>(args)...);
+        });
+  }
+  /// Invokes the callable with the arguments of the given const signature,
+  /// which are loaded from a buffer that is laid out as described by
+  /// fu2::buffer_layout, without decoding them into a tuple first.
+  template <typename Signature =
+                std::tuple_element_t<0U, std::tuple<Args...>>,
+            typename Index = signature_index_of_t<Signature>>
+  decltype(auto) invoke_from_buffer(void const* data,
+                                    std::size_t size) const {
+    static_assert(is_const_signature<Signature>::value,
+                  "The signature isn't const qualified!");
+    assert((size >= buffer_layout_t<Signature>::size) &&
+           "The buffer is too small to hold all arguments!");
+    (void)size;
+    return buffer_layout_t<Signature>::load(
+        data, [&](auto&&... args) -> decltype(auto) {
+          return erasure_t::template invoke<Index::value>(
+              erasure_, std::forward<decltype(args)>(args)...);
+        });
+  }
+
+  /// Returns a callable which invokes the given callable with the result
+  /// of this function, see fu2::compose for details.
+  template <typename T>
+  auto then(T&& callable) const& {
+    return composition::compose(*this, std::forward<T>(callable));
+  }
+  /// Returns a callable which invokes the given callable with the result
+  /// of this function, see fu2::compose for details.
+  template <typename T>
+  auto then(T&& callable) && {
+    return composition::compose(std::move(*this), std::forward<T>(callable));
+  }
+
   /// Assigns a new target with an optional allocator
   template <typename T, typename Allocator = std::allocator<std::decay_t<T>>,
             enable_if_not_convertible_to_this<T>* = nullptr,
@@ -1667,6 +4238,43 @@ public:
                     std::forward<Allocator>(allocator_));
   }
 
+  /// Replaces the callable by a callable of type T which is constructed
+  /// from the given arguments directly inside the storage of the function.
+  ///
+  /// In contrast to the assignment, the callable is stored even
+  /// if it evaluates to false.
+  template <typename T, typename... CtorArgs,
+            enable_if_can_accept_all_t<T>* = nullptr,
+            enable_if_owning_t<T>* = nullptr,
+            assert_wrong_copy_assign_t<T>* = nullptr,
+            assert_no_strong_except_guarantee_t<T>* = nullptr>
+  T& emplace(CtorArgs&&... args) {
+    return erasure_.emplace(in_place_type_t<T>{}, std::allocator<T>{},
+                            std::forward<CtorArgs>(args)...);
+  }
+
+  /// Reserves a heap block of at least the given size while the function
+  /// is empty, which is reused by all later assignments of callables
+  /// which fit into it instead of allocating memory for them.
+  /// Callables which fit into the internal capacity are still stored
+  /// inplace, so calling them doesn't go through the heap block.
+  ///
+  /// The block is kept when the function is cleared and released
+  /// when the function is destroyed, or when a callable is assigned
+  /// which is stored inplace or doesn't fit into it.
+  /// Callables assigned together with an allocator which isn't always
+  /// equal are allocated through their allocator, and release the block.
+  ///
+  /// The function is required to be empty, unless it holds a reserved
+  /// block which is large enough already. Reserving memory for a function
+  /// which holds a callable is asserted and has no effect otherwise.
+  template <typename T = void, enable_if_owning_t<T>* = nullptr>
+  void reserve(std::size_t size) {
+    static_assert(!Config::is_strict,
+                  "Strict functions never allocate memory to reserve!");
+    erasure_.reserve(size);
+  }
+
   /// Swaps this function with the given function
   void swap(function& other) noexcept(HasStrongExceptGuarantee) {
     if (&other == this) {
@@ -1685,8 +4293,7 @@ public:
   }
 
   /// Calls the wrapped callable object
-  using type_erasure::invocation_table::operator_impl<
-      0U, function<Config, property_t>, Args...>::operator();
+  using expanded_t::operator_t::operator();
 };
 
 template <typename Config, typename Property>
@@ -1709,42 +4316,993 @@ bool operator!=(std::nullptr_t, function<Config, Property> const& f) {
   return bool(f);
 }
 
-// Default intended object size of the function
-using object_size = std::integral_constant<std::size_t, 32U>;
-} // namespace detail
-} // namespace abi_400
-
-/// Can be passed to function_base as template argument which causes
-/// the internal small buffer to be sized according to the given size,
-/// and aligned with the given alignment.
-template <std::size_t Capacity,
-          std::size_t Alignment = alignof(std::max_align_t)>
-struct capacity_fixed {
-  static constexpr std::size_t capacity = Capacity;
-  static constexpr std::size_t alignment = Alignment;
-};
+/// Deduces to a true type if objects of the given type may be relocated
+/// through copying their bytes
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+template <typename Config, typename Property>
+struct is_trivially_relocatable<function<Config, Property>>
+    : std::integral_constant<bool, !Config::is_owning ||
+                                       Config::is_trivially_relocatable> {};
 
-/// Default capacity for small functor optimization
-struct capacity_default
-    : capacity_fixed<detail::object_size::value - (2 * sizeof(void*))> {};
+template <typename Config, typename Property>
+function<Config, Property>* relocate_n(function<Config, Property>* first,
+                                       std::size_t count,
+                                       function<Config, Property>* dest) {
+  using function_t = function<Config, Property>;
+
+  if (is_trivially_relocatable<function_t>::value) {
+    std::memcpy(static_cast<void*>(dest), static_cast<void const*>(first),
+                count * sizeof(function_t));
+    return dest + count;
+  }
 
-/// Can be passed to function_base as template argument which causes
-/// the internal small buffer to be removed from the callable wrapper.
-/// The owning function_base will then allocate memory for every object
-/// it applies a type erasure on.
-struct capacity_none : capacity_fixed<0UL> {};
+  std::size_t i = 0;
+  while (i < count) {
+    // Copy all subsequent functions at once which are relocatable bitwise
+    std::size_t end = i;
+    while ((end < count) && first[end].erasure_.is_trivially_relocatable()) {
+      ++end;
+    }
+    if (end != i) {
+      std::memcpy(static_cast<void*>(dest + i),
+                  static_cast<void const*>(first + i),
+                  (end - i) * sizeof(function_t));
+      i = end;
+      continue;
+    }
 
-/// Can be passed to function_base as template argument which causes
-/// the internal small buffer to be sized such that it can hold
-/// the given object without allocating memory for an applied type erasure.
-template <typename T>
-struct capacity_can_hold {
-  static constexpr std::size_t capacity = sizeof(T);
-  static constexpr std::size_t alignment = alignof(T);
-};
+    new (dest + i) function_t(std::move(first[i]));
+    first[i].~function_t();
+    ++i;
+  }
+  return dest + count;
+}
 
-/// An adaptable function wrapper base for arbitrary functional types.
-///
+/// Deduces to a true type if all signatures of the function are const
+/// qualified, which allows many threads to invoke it concurrently.
+template <typename Function>
+struct has_const_signatures_only : std::false_type {};
+template <typename Config, bool IsThrowing, bool HasStrongExceptGuarantee,
+          typename... Args>
+struct has_const_signatures_only<
+    function<Config, property<IsThrowing, HasStrongExceptGuarantee, Args...>>>
+    : std::is_same<
+          std::integer_sequence<
+              bool, true,
+              std::is_const<std::remove_reference_t<
+                  typename type_erasure::invocation_table::function_trait<
+                      Args>::template callable<int>>>::value...>,
+          std::integer_sequence<
+              bool,
+              std::is_const<std::remove_reference_t<
+                  typename type_erasure::invocation_table::function_trait<
+                      Args>::template callable<int>>>::value...,
+              true>> {};
+
+/// A wrapper around an owning function, which may be invoked by many
+/// threads concurrently while its callable is replaced through store.
+///
+/// Readers announce themselves through a counter of the current epoch,
+/// which never blocks. A store publishes the new callable, retires the
+/// previous one and flips the epoch, such that new readers use the other
+/// counter. Retired callables are destroyed by a later store or the
+/// destructor, as soon as both counters were observed to be zero after
+/// the callable was retired. Thus store never waits for the readers.
+///
+/// Threads are spread round robin over several reader slots, each
+/// of them padded to its own cache line, so concurrent readers
+/// rarely write to the same line.
+template <typename Function>
+class atomic_function {
+  static_assert(has_const_signatures_only<Function>::value,
+                "All threads invoke the same callable, therefore all "
+                "signatures have to be const qualified!");
+
+  /// The assumed size of a cache line
+  static constexpr std::size_t cache_line_size = 64U;
+  /// The number of reader slots the threads are spread over
+  static constexpr std::size_t slot_count = 16U;
+
+  struct node {
+    Function function_;
+    /// The next retired node
+    node* next_;
+    /// The counters which were observed to be zero after the retirement
+    unsigned drained_;
+  };
+
+  /// The reader counters of both epochs which are used by a set of threads
+  struct alignas(cache_line_size) slot {
+    std::atomic<std::size_t> readers_[2];
+  };
+
+  /// Returns the slot of the calling thread
+  static std::size_t slot_index() noexcept {
+    static std::atomic<std::size_t> next{0U};
+    static thread_local std::size_t const index =
+        next.fetch_add(1U, std::memory_order_relaxed) % slot_count;
+    return index;
+  }
+
+  /// Announces a reader in the current epoch while it is alive
+  class reader {
+    std::atomic<std::size_t>* counter_;
+
+  public:
+    explicit reader(atomic_function const& me) noexcept
+        : counter_(&me.slots_[slot_index()].readers_[me.epoch_.load() & 1U]) {
+      counter_->fetch_add(1U);
+    }
+    reader(reader const&) = delete;
+    reader& operator=(reader const&) = delete;
+    ~reader() {
+      counter_->fetch_sub(1U, std::memory_order_release);
+    }
+  };
+
+  /// Written by store only, read by all readers
+  alignas(cache_line_size) std::atomic<node*> current_;
+  std::atomic<std::size_t> epoch_{0U};
+  mutable slot slots_[slot_count]{};
+  /// The stack of retired nodes which weren't destroyed yet
+  std::atomic<node*> retired_{nullptr};
+  std::atomic_flag reclaiming_ = ATOMIC_FLAG_INIT;
+
+  /// Returns true when no reader of the given epoch is left
+  bool is_drained(std::size_t epoch) const noexcept {
+    for (slot const& current : slots_) {
+      // Sequentially consistent to be ordered against the increment
+      // of a reader and its following load of the current callable
+      if (current.readers_[epoch & 1U].load() != 0U) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void retire(node* retired) noexcept {
+    retired->next_ = retired_.load(std::memory_order_relaxed);
+    while (!retired_.compare_exchange_weak(retired->next_, retired,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+    }
+  }
+
+  /// Destroys all retired nodes which can't be invoked anymore.
+  /// Does nothing if another thread reclaims the nodes already.
+  void reclaim() {
+    if (reclaiming_.test_and_set(std::memory_order_acquire)) {
+      return;
+    }
+
+    node* pending = retired_.exchange(nullptr, std::memory_order_acquire);
+    unsigned const drained = (is_drained(0U) ? 1U : 0U) |
+                             (is_drained(1U) ? 2U : 0U);
+    std::size_t epoch = epoch_.load();
+    if ((drained != 0U) && !(drained & (1U << (epoch & 1U)))) {
+      // Move new readers to the drained counter, such that the counter
+      // which is still in use drains until the next reclaim.
+      epoch_.compare_exchange_strong(epoch, epoch + 1U);
+    }
+
+    node* reclaimable = nullptr;
+    while (pending) {
+      node* next = pending->next_;
+      pending->drained_ |= drained;
+      if (pending->drained_ == 3U) {
+        pending->next_ = reclaimable;
+        reclaimable = pending;
+      } else {
+        retire(pending);
+      }
+      pending = next;
+    }
+    reclaiming_.clear(std::memory_order_release);
+
+    // Destroy the callables without holding the flag,
+    // since their destructor may store into this function.
+    while (reclaimable) {
+      node* next = reclaimable->next_;
+      delete reclaimable;
+      reclaimable = next;
+    }
+  }
+
+public:
+  atomic_function()
+      : current_(new node{Function{}, nullptr, 0U}) {
+  }
+  template <typename T>
+  explicit atomic_function(T&& callable)
+      : current_(
+            new node{Function(std::forward<T>(callable)), nullptr, 0U}) {
+  }
+  atomic_function(atomic_function const&) = delete;
+  atomic_function& operator=(atomic_function const&) = delete;
+  ~atomic_function() {
+    node* pending = retired_.load(std::memory_order_acquire);
+    while (pending) {
+      node* next = pending->next_;
+      delete pending;
+      pending = next;
+    }
+    delete current_.load();
+  }
+
+  /// Replaces the callable without waiting for the readers. The previous
+  /// callable is destroyed by a later store or the destructor, as soon as
+  /// no reader invokes it anymore.
+  template <typename T>
+  void store(T&& callable) {
+    node* next =
+        new node{Function(std::forward<T>(callable)), nullptr, 0U};
+    node* previous = current_.exchange(next);
+    retire(previous);
+    // New readers use the other counter, so the current one drains
+    epoch_.fetch_add(1U);
+    reclaim();
+  }
+
+  /// Invokes the current callable with the given arguments
+  template <typename... Args>
+  decltype(auto) operator()(Args&&... args) const {
+    reader const guard(*this);
+    Function const& function = current_.load()->function_;
+    return function(std::forward<Args>(args)...);
+  }
+
+  /// Returns true when the current callable isn't empty
+  explicit operator bool() const noexcept {
+    reader const guard(*this);
+    return bool(current_.load()->function_);
+  }
+};
+
+/// A non owning function wrapper which is used as parameter type, that
+/// references a callable like a function_view and additionally records
+/// how the callable is moved or copied into an owning function.
+///
+/// A callable which was passed as rvalue is moved by materialize,
+/// a callable which was passed as lvalue is copied. A move only callable
+/// passed as lvalue is referenced too, but it can't be materialized.
+template <typename Capacity, typename... Signatures>
+class function_arg {
+  using view_t = function<config<false, true, Capacity>,
+                          property<true, false, Signatures...>>;
+  using unique_t = function<config<true, false, Capacity>,
+                            property<true, false, Signatures...>>;
+  using copyable_t = function<config<true, true, Capacity>,
+                              property<true, false, Signatures...>>;
+
+  template <typename Function>
+  using materializer_t = Function (*)(void* object);
+
+  view_t view_;
+  void* object_;
+  materializer_t<unique_t> to_unique_;
+  materializer_t<copyable_t> to_copyable_;
+
+  template <typename T>
+  static constexpr bool is_movable() noexcept {
+    return !std::is_lvalue_reference<T>::value &&
+           !std::is_const<std::remove_reference_t<T>>::value;
+  }
+  /// A callable passed as lvalue is materialized through a copy,
+  /// which a callable that is only movable doesn't support
+  template <typename T>
+  static constexpr bool is_materializable() noexcept {
+    return is_movable<T>() ||
+           std::is_copy_constructible<std::decay_t<T>>::value;
+  }
+
+  template <typename T, typename Function>
+  static Function materialize_as(void* object) {
+    using taker_t = type_erasure::address_taker<std::decay_t<T>>;
+    auto&& callable = taker_t::restore(object);
+    return construct<Function>(
+        std::integral_constant<bool, is_movable<T>()>{}, callable);
+  }
+
+  template <typename Function, typename Callable>
+  static Function construct(std::true_type /*is_movable*/,
+                            Callable& callable) {
+    return Function(std::move(callable));
+  }
+  template <typename Function, typename Callable>
+  static Function construct(std::false_type /*is_movable*/,
+                            Callable& callable) {
+    return Function(callable);
+  }
+
+  template <typename T>
+  static materializer_t<unique_t>
+  unique_of(std::true_type /*is_constructible*/) noexcept {
+    return &materialize_as<T, unique_t>;
+  }
+  template <typename T>
+  static materializer_t<unique_t>
+  unique_of(std::false_type /*is_constructible*/) noexcept {
+    return nullptr;
+  }
+
+  template <typename T>
+  static materializer_t<copyable_t>
+  copyable_of(std::true_type /*is_copy_constructible*/) noexcept {
+    return &materialize_as<T, copyable_t>;
+  }
+  template <typename T>
+  static materializer_t<copyable_t>
+  copyable_of(std::false_type /*is_copy_constructible*/) noexcept {
+    return nullptr;
+  }
+
+  template <typename T>
+  using enable_if_not_this_t = std::enable_if_t<
+      !std::is_same<std::decay_t<T>, function_arg>::value &&
+      std::is_constructible<view_t, T&>::value>;
+
+public:
+  /// References the given callable
+  template <typename T, enable_if_not_this_t<T>* = nullptr>
+  function_arg(T&& callable) noexcept
+      : view_(callable),
+        object_(const_cast<void*>(static_cast<void const volatile*>(
+            type_erasure::address_taker<std::decay_t<T>>::take(callable)))),
+        to_unique_(unique_of<T>(
+            std::integral_constant<bool, is_materializable<T>()>{})),
+        to_copyable_(copyable_of<T>(
+            std::is_copy_constructible<std::decay_t<T>>{})) {
+  }
+
+  /// Invokes the referenced callable
+  template <typename... Args>
+  decltype(auto) operator()(Args&&... args) {
+    return view_(std::forward<Args>(args)...);
+  }
+
+  /// Returns true when the referenced callable isn't empty
+  explicit operator bool() const noexcept {
+    return bool(view_);
+  }
+
+  /// Returns a unique_function which holds the referenced callable,
+  /// which is moved out of it when it was passed as rvalue.
+  ///
+  /// A callable passed as rvalue should be materialized at most once.
+  ///
+  /// Throws bad_function_call, or calls std::abort if exceptions are
+  /// disabled, when the referenced callable was passed as lvalue
+  /// and isn't copyable.
+  unique_t materialize() {
+    if (!to_unique_) {
+      type_erasure::invocation_table::throw_or_abort(std::true_type{});
+    }
+    return to_unique_(object_);
+  }
+
+  /// Returns a copyable function which holds the referenced callable,
+  /// which is moved out of it when it was passed as rvalue.
+  ///
+  /// Throws bad_function_call, or calls std::abort if exceptions are
+  /// disabled, when the referenced callable isn't copyable.
+  copyable_t materialize_copyable() {
+    if (!to_copyable_) {
+      type_erasure::invocation_table::throw_or_abort(std::true_type{});
+    }
+    return to_copyable_(object_);
+  }
+};
+
+namespace closed_set {
+/// Returns the largest of the given values
+constexpr std::size_t max_of(std::size_t value) noexcept {
+  return value;
+}
+template <typename... Rest>
+constexpr std::size_t max_of(std::size_t first, std::size_t second,
+                             Rest... rest) noexcept {
+  return max_of(first > second ? first : second, rest...);
+}
+
+/// Deduces to the index of T inside the given types,
+/// or to the count of the types if it isn't contained.
+template <typename T, typename... Types>
+struct index_of : std::integral_constant<std::size_t, 0U> {};
+template <typename T, typename... Rest>
+struct index_of<T, T, Rest...> : std::integral_constant<std::size_t, 0U> {};
+template <typename T, typename First, typename... Rest>
+struct index_of<T, First, Rest...>
+    : std::integral_constant<std::size_t, 1U + index_of<T, Rest...>::value> {};
+
+/// Applies the visitor to the object inside the storage whose type is
+/// at the given index, or calls otherwise if there is no such type.
+///
+/// The comparisons of the index against constants are inlined into
+/// each other, so the compiler lowers them into a switch without
+/// any indirect call.
+template <typename Ret, std::size_t Index, typename... Types>
+struct dispatch {
+  template <typename Storage, typename Visitor, typename Otherwise>
+  static Ret apply(std::size_t /*index*/, Storage* /*storage*/,
+                   Visitor&& /*visitor*/, Otherwise&& otherwise) {
+    return otherwise();
+  }
+};
+template <typename Ret, std::size_t Index, typename First, typename... Rest>
+struct dispatch<Ret, Index, First, Rest...> {
+  template <typename Storage, typename Visitor, typename Otherwise>
+  static Ret apply(std::size_t index, Storage* storage, Visitor&& visitor,
+                   Otherwise&& otherwise) {
+    using type_erasure::transfer_const_t;
+    using type_erasure::transfer_volatile_t;
+    using void_type =
+        transfer_const_t<Storage*, transfer_volatile_t<Storage*, void>>;
+    using object_type =
+        transfer_const_t<Storage*, transfer_volatile_t<Storage*, First>>;
+
+    if (index == Index) {
+      return visitor(
+          static_cast<object_type*>(static_cast<void_type*>(storage)));
+    }
+    return dispatch<Ret, Index + 1U, Rest...>::apply(
+        index, storage, std::forward<Visitor>(visitor),
+        std::forward<Otherwise>(otherwise));
+  }
+};
+
+/// Deduces to a true type if all of the given values are true
+template <bool... Values>
+using all_of = std::is_same<std::integer_sequence<bool, true, Values...>,
+                            std::integer_sequence<bool, Values..., true>>;
+
+/// Holds an object of one of the given types inside a storage that is
+/// large enough for all of them, together with the index of its type.
+///
+/// The storage is moved without throwing when all types are
+/// nothrow move constructible.
+template <typename... T>
+class storage {
+  static constexpr bool is_nothrow_movable =
+      all_of<std::is_nothrow_move_constructible<T>::value...>::value;
+
+protected:
+  using index_t =
+      std::conditional_t<(sizeof...(T) < 255U), unsigned char, std::size_t>;
+
+  struct alignas(T...) storage_t {
+    unsigned char data_[max_of(sizeof(T)...)];
+  };
+
+  storage_t storage_;
+  index_t index_;
+
+  template <typename Ret, typename Self, typename Visitor, typename Otherwise>
+  static Ret visit(Self& self, Visitor&& visitor, Otherwise&& otherwise) {
+    return dispatch<Ret, 0U, T...>::apply(self.index_, &self.storage_,
+                                          std::forward<Visitor>(visitor),
+                                          std::forward<Otherwise>(otherwise));
+  }
+
+  void copy(storage const& right) {
+    visit<void>(
+        right,
+        [&](auto* obj) {
+          using type = std::remove_cv_t<std::remove_pointer_t<decltype(obj)>>;
+          new (&storage_) type(*obj);
+        },
+        [] {});
+    index_ = right.index_;
+  }
+
+  void move(storage& right) noexcept(is_nothrow_movable) {
+    visit<void>(
+        right,
+        [&](auto* obj) {
+          using type = std::remove_pointer_t<decltype(obj)>;
+          new (&storage_) type(std::move(*obj));
+        },
+        [] {});
+    index_ = right.index_;
+    right.reset();
+  }
+
+  void reset() noexcept {
+    visit<void>(
+        *this,
+        [](auto* obj) {
+          using type = std::remove_pointer_t<decltype(obj)>;
+          obj->~type();
+        },
+        [] {});
+    index_ = sizeof...(T);
+  }
+
+public:
+  storage() noexcept : index_(sizeof...(T)) {
+  }
+  storage(storage const& right) : index_(sizeof...(T)) {
+    copy(right);
+  }
+  storage(storage&& right) noexcept(is_nothrow_movable)
+      : index_(sizeof...(T)) {
+    move(right);
+  }
+  ~storage() {
+    reset();
+  }
+
+  storage& operator=(storage const& right) {
+    if (this != &right) {
+      reset();
+      copy(right);
+    }
+    return *this;
+  }
+  storage& operator=(storage&& right) noexcept(is_nothrow_movable) {
+    if (this != &right) {
+      reset();
+      move(right);
+    }
+    return *this;
+  }
+};
+
+/// Deletes the copy operations of the class deriving from it,
+/// unless IsCopyable is true.
+template <bool IsCopyable>
+struct copy_guard {};
+template <>
+struct copy_guard<false> {
+  copy_guard() = default;
+  copy_guard(copy_guard const&) = delete;
+  copy_guard(copy_guard&&) = default;
+  copy_guard& operator=(copy_guard const&) = delete;
+  copy_guard& operator=(copy_guard&&) = default;
+};
+
+template <typename Function, typename Signature>
+class operator_impl;
+
+#define FU2_DEFINE_FUNCTION_TRAIT(CONST, VOLATILE, NOEXCEPT, OVL_REF, REF)     \
+  template <typename Function, typename Ret, typename... Args>                 \
+  class operator_impl<Function,                                                \
+                      Ret(Args...) CONST VOLATILE OVL_REF NOEXCEPT> {          \
+  public:                                                                      \
+    Ret operator()(Args... args) CONST VOLATILE OVL_REF NOEXCEPT {             \
+      auto parent = static_cast<Function CONST VOLATILE*>(this);               \
+      return Function::template visit<Ret>(                                    \
+          *parent,                                                             \
+          [&](auto* obj) -> Ret {                                              \
+            return invocation::invoke(                                         \
+                static_cast<std::remove_pointer_t<decltype(obj)> REF>(*obj),   \
+                std::forward<Args>(args)...);                                  \
+          },                                                                   \
+          []() -> Ret {                                                        \
+            type_erasure::invocation_table::throw_or_abort##NOEXCEPT(          \
+                std::true_type{});                                             \
+          });                                                                  \
+    }                                                                          \
+  };
+
+FU2_DETAIL_EXPAND_QUALIFIERS(FU2_DEFINE_FUNCTION_TRAIT)
+#undef FU2_DEFINE_FUNCTION_TRAIT
+} // namespace closed_set
+
+/// A function wrapper which holds an object of one of the given types
+/// inside a storage that is large enough for all of them, together with
+/// the index of its type.
+///
+/// Invocations select the type through the index instead of calling
+/// a thunk indirectly, which allows the compiler to inline the callables.
+/// Empty invocations throw bad_function_call or abort if exceptions
+/// are disabled.
+template <typename Signature, typename... T>
+class function_of
+    : public closed_set::operator_impl<function_of<Signature, T...>,
+                                       Signature>,
+      closed_set::storage<T...>,
+      closed_set::copy_guard<
+          closed_set::all_of<std::is_copy_constructible<T>::value...>::value> {
+  static_assert(sizeof...(T) > 0U, "At least one type is required!");
+
+  template <typename, typename>
+  friend class closed_set::operator_impl;
+
+  using storage_base_t = closed_set::storage<T...>;
+  using typename storage_base_t::index_t;
+
+  template <typename U>
+  using enable_if_contained_t = std::enable_if_t<(
+      closed_set::index_of<std::decay_t<U>, T...>::value < sizeof...(T))>;
+
+  template <typename Ret, typename Self, typename Visitor, typename Otherwise>
+  static Ret visit(Self& self, Visitor&& visitor, Otherwise&& otherwise) {
+    return closed_set::dispatch<Ret, 0U, T...>::apply(
+        self.index_, &self.storage_, std::forward<Visitor>(visitor),
+        std::forward<Otherwise>(otherwise));
+  }
+
+  template <typename U>
+  void construct(U&& callable) {
+    using type = std::decay_t<U>;
+    static_assert(accepts_one<type, Signature>::value,
+                  "The callable doesn't accept the signature!");
+
+    new (&this->storage_) type(std::forward<U>(callable));
+    this->index_ =
+        static_cast<index_t>(closed_set::index_of<type, T...>::value);
+  }
+
+public:
+  function_of() noexcept = default;
+  function_of(std::nullptr_t) noexcept {
+  }
+  template <typename U, enable_if_contained_t<U>* = nullptr>
+  function_of(U&& callable) {
+    construct(std::forward<U>(callable));
+  }
+
+  /// The function is copyable if all types are copyable,
+  /// and nothrow movable if all types are nothrow movable.
+  function_of(function_of const&) = default;
+  function_of(function_of&&) = default;
+  function_of& operator=(function_of const&) = default;
+  function_of& operator=(function_of&&) = default;
+
+  template <typename U, enable_if_contained_t<U>* = nullptr>
+  function_of& operator=(U&& callable) {
+    this->reset();
+    construct(std::forward<U>(callable));
+    return *this;
+  }
+  function_of& operator=(std::nullptr_t) noexcept {
+    this->reset();
+    return *this;
+  }
+
+  /// Returns the index of the type of the held object inside T,
+  /// or the count of the types when the function is empty
+  std::size_t index() const noexcept {
+    return this->index_;
+  }
+
+  /// Returns true when the function is empty
+  bool empty() const noexcept {
+    return this->index_ == sizeof...(T);
+  }
+
+  /// Returns true when the function isn't empty
+  explicit operator bool() const noexcept {
+    return !empty();
+  }
+};
+
+namespace binding {
+/// Transfers the const and reference qualifiers of Self onto T
+template <typename Self, typename T>
+using forward_like_t = std::conditional_t<
+    std::is_const<std::remove_reference_t<Self>>::value,
+    std::conditional_t<std::is_lvalue_reference<Self>::value, T const&,
+                       T const&&>,
+    std::conditional_t<std::is_lvalue_reference<Self>::value, T&, T&&>>;
+
+/// Holds a member function or function pointer which is known at compile
+/// time, which is empty and lets the compiler call the method directly
+template <typename Method, Method Value>
+struct constant_method {
+  static constexpr Method method() noexcept {
+    return Value;
+  }
+};
+
+/// A callable which invokes the method with the object and the bound
+/// arguments in front of the arguments it is invoked with.
+///
+/// The method and the bound arguments are base classes, so they don't
+/// take any space when they are empty, which keeps the callable small
+/// enough to be stored inplace by a function.
+template <typename Holder, typename Object, typename... Bound>
+class bound_front : Holder, std::tuple<Bound...> {
+  using bound_t = std::tuple<Bound...>;
+  using indices_t = std::make_index_sequence<sizeof...(Bound)>;
+
+  Object object_;
+
+  template <typename Self, std::size_t... I, typename... Args>
+  static constexpr auto apply(Self&& self, std::index_sequence<I...>,
+                              Args&&... args)
+      -> decltype(invocation::invoke(
+          self.method(),
+          static_cast<forward_like_t<Self, Object>>(self.object_),
+          std::get<I>(static_cast<forward_like_t<Self, bound_t>>(self))...,
+          std::forward<Args>(args)...)) {
+    return invocation::invoke(
+        self.method(), static_cast<forward_like_t<Self, Object>>(self.object_),
+        std::get<I>(static_cast<forward_like_t<Self, bound_t>>(self))...,
+        std::forward<Args>(args)...);
+  }
+
+public:
+  template <typename O, typename... B>
+  constexpr bound_front(Holder holder, O&& object, B&&... bound)
+      : Holder(std::move(holder)), bound_t(std::forward<B>(bound)...),
+        object_(std::forward<O>(object)) {
+  }
+
+  template <typename... Args>
+  constexpr auto operator()(Args&&... args) & -> decltype(
+      apply(std::declval<bound_front&>(), indices_t{},
+            std::forward<Args>(args)...)) {
+    return apply(*this, indices_t{}, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  constexpr auto operator()(Args&&... args) const& -> decltype(
+      apply(std::declval<bound_front const&>(), indices_t{},
+            std::forward<Args>(args)...)) {
+    return apply(*this, indices_t{}, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  constexpr auto operator()(Args&&... args) && -> decltype(
+      apply(std::declval<bound_front&&>(), indices_t{},
+            std::forward<Args>(args)...)) {
+    return apply(std::move(*this), indices_t{}, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  constexpr auto operator()(Args&&... args) const&& -> decltype(
+      apply(std::declval<bound_front const&&>(), indices_t{},
+            std::forward<Args>(args)...)) {
+    return apply(std::move(*this), indices_t{}, std::forward<Args>(args)...);
+  }
+};
+} // namespace binding
+
+namespace speculation {
+/// Deduces to the probe of the call operators of the given function
+template <typename Function>
+struct probe_of;
+template <typename Config, bool IsThrowing, bool HasStrongExceptGuarantee,
+          typename... Args>
+struct probe_of<
+    function<Config, property<IsThrowing, HasStrongExceptGuarantee, Args...>>> {
+  using type = typename expanded_function_t<Config, IsThrowing,
+                                            HasStrongExceptGuarantee,
+                                            Args...>::probe_t;
+};
+
+/// Deduces to the type To qualified like the type From
+template <typename From, typename To,
+          typename Plain = std::remove_reference_t<From>>
+using transfer_cvref_t = std::conditional_t<
+    std::is_lvalue_reference<From>::value,
+    type_erasure::transfer_volatile_t<
+        Plain, type_erasure::transfer_const_t<Plain, To>>&,
+    type_erasure::transfer_volatile_t<
+        Plain, type_erasure::transfer_const_t<Plain, To>>&&>;
+
+/// Deduces to the signature which is returned by the probe
+template <typename Selected>
+struct unwrap_signature;
+template <typename Signature>
+struct unwrap_signature<identity<Signature>> {
+  using type = Signature;
+};
+
+/// Deduces to the signature which is selected by calling the given
+/// function with the given arguments
+template <typename Function, typename... Args>
+using selected_signature_t = typename unwrap_signature<decltype(
+    std::declval<transfer_cvref_t<
+        Function, typename probe_of<std::remove_cv_t<
+                      std::remove_reference_t<Function>>>::type>>()(
+        std::declval<Args>()...))>::type;
+
+/// Invokes the callable held by the function directly if it is of one
+/// of the given types, or through the erased call otherwise
+///
+/// The type is checked through the const target, which never copies
+/// a shared callable. The callable is invoked with the qualifiers of the
+/// signature which the call operator selects, where a mutable signature
+/// acquires the mutable target first, exactly like the erased call does.
+template <typename Result, typename... T>
+struct invoker {
+  template <typename Function, typename... Args>
+  static Result invoke(Function&& function, Args&&... args) {
+    return std::forward<Function>(function)(std::forward<Args>(args)...);
+  }
+};
+template <typename Result, typename First, typename... Rest>
+struct invoker<Result, First, Rest...> {
+  template <typename Function, typename... Args>
+  static Result invoke(Function&& function, Args&&... args) {
+    auto const& peek = function;
+    if (First const* target = peek.template target<First>()) {
+      using signature_t = selected_signature_t<Function, Args&&...>;
+      using trait_t =
+          type_erasure::invocation_table::function_trait<signature_t>;
+      using callable_t = typename trait_t::template callable<First>;
+      using is_const = std::is_const<std::remove_reference_t<callable_t>>;
+
+      return static_cast<Result>(invocation::invoke(
+          static_cast<callable_t>(*acquire(is_const{}, function, target)),
+          std::forward<Args>(args)...));
+    }
+    return invoker<Result, Rest...>::invoke(std::forward<Function>(function),
+                                            std::forward<Args>(args)...);
+  }
+
+private:
+  template <typename Function>
+  static First* acquire(std::true_type /*is_const*/, Function& /*function*/,
+                        First const* target) noexcept {
+    return const_cast<First*>(target);
+  }
+  template <typename Function>
+  static First* acquire(std::false_type /*is_const*/, Function& function,
+                        First const* /*target*/) {
+    return function.template target<First>();
+  }
+};
+} // namespace speculation
+
+// Default intended object size of the function
+using object_size = std::integral_constant<std::size_t, 32U>;
+} // namespace detail
+} // namespace abi_400
+
+/// Can be passed to function_base as template argument which causes
+/// the internal small buffer to be sized according to the given size,
+/// and aligned with the given alignment.
+template <std::size_t Capacity,
+          std::size_t Alignment = alignof(std::max_align_t)>
+struct capacity_fixed {
+  static constexpr std::size_t capacity = Capacity;
+  static constexpr std::size_t alignment = Alignment;
+};
+
+/// Default capacity for small functor optimization
+struct capacity_default
+    : capacity_fixed<detail::object_size::value - (2 * sizeof(void*))> {};
+
+/// Can be passed to function_base as template argument which causes
+/// the internal small buffer to be removed from the callable wrapper.
+/// The owning function_base will then allocate memory for every object
+/// it applies a type erasure on.
+struct capacity_none : capacity_fixed<0UL> {};
+
+/// Can be passed to function_base as template argument which causes
+/// the internal small buffer to be sized such that it can hold
+/// the given object without allocating memory for an applied type erasure.
+template <typename T>
+struct capacity_can_hold {
+  static constexpr std::size_t capacity = sizeof(T);
+  static constexpr std::size_t alignment = alignof(T);
+};
+
+/// Can be passed to function_base as template argument which causes
+/// the command function and the invokers of an erased object to be merged
+/// into a single static table, such that the function only holds one
+/// pointer to it instead of two.
+///
+/// By default the saved pointer is added to the internal capacity,
+/// which keeps the object size of the function unchanged.
+/// Invocations load the thunk through the static table.
+///
+/// Functions which don't merge their tables, like fu2::function, can't
+/// take over the callable of a merged function and the other way around.
+/// The function is wrapped as callable then, which costs an additional
+/// indirect call and may allocate it on the heap.
+template <typename Capacity =
+              capacity_fixed<detail::object_size::value - sizeof(void*),
+                             alignof(void*)>>
+struct capacity_merged : Capacity {
+  static constexpr bool is_merged = true;
+};
+
+/// Can be passed to function_base as template argument which causes the
+/// function to hold a single pointer to the merged table and one pointer
+/// sized word of internal capacity, such as a captured `this` pointer.
+///
+/// This halves the size of the function to two pointers,
+/// while larger callables are allocated on the heap.
+struct capacity_compact
+    : capacity_merged<capacity_fixed<sizeof(void*), alignof(void*)>> {};
+
+/// Can be passed to function_base as template argument which causes
+/// the invokers of all signatures to be stored inside the function object
+/// instead of a pointer to a static table of them.
+///
+/// This increases the size of the function by one pointer for every
+/// additional signature, but saves one dependent load on every invocation
+/// of a function with multiple signatures.
+///
+/// Converting between functions with inlined invokers and functions
+/// which reference a static table wraps the converted function.
+template <typename Capacity = capacity_default>
+struct capacity_inlined : Capacity {
+  static constexpr bool is_inlined = true;
+};
+
+/// Can be passed to function_base as template argument which causes
+/// only callables with a noexcept move constructor to be allocated inplace,
+/// while all others are allocated on the heap.
+/// Callables aligned stricter than Capacity::alignment are always
+/// allocated on the heap, so a move never has to allocate them.
+///
+/// Moving the function then only moves such callables or the pointer
+/// to the heap, which makes the function nothrow move constructible
+/// and move assignable regardless of HasStrongExceptGuarantee, so that
+/// containers move instead of copy it when they grow.
+/// Functions which allocate under other rules are wrapped as callable
+/// when they are converted into such a function, and the other way around.
+template <typename Capacity = capacity_default>
+struct capacity_nothrow_movable : Capacity {
+  static constexpr bool is_nothrow_movable = true;
+};
+
+/// Can be passed to function_base as template argument which causes
+/// only trivially copyable callables to be allocated inplace,
+/// while all others are allocated on the heap.
+///
+/// The function may then be relocated bitwise, which is advertised
+/// through fu2::is_trivially_relocatable and used by fu2::relocate_n.
+/// Conversions from or into functions without this rule wrap the
+/// converted function as callable, which is allocated on the heap then.
+template <typename Capacity = capacity_default>
+struct capacity_trivially_relocatable : Capacity {
+  static constexpr bool is_trivially_relocatable = true;
+};
+
+/// Can be passed to function_base as template argument which causes
+/// the internal small buffer to be sized according to the given size,
+/// while callables that don't fit into it are rejected at compile time
+/// instead of being allocated on the heap.
+///
+/// Functions using this capacity never allocate memory, and the code
+/// paths which would allocate callables are never instantiated.
+/// Other functions, including strict ones of a different capacity,
+/// are only accepted as callable, which has to fit into the capacity.
+template <std::size_t Capacity,
+          std::size_t Alignment = alignof(std::max_align_t)>
+struct capacity_strict : capacity_fixed<Capacity, Alignment> {
+  static constexpr bool is_strict = true;
+};
+
+/// Can be passed to function_base as template argument which causes
+/// the function to store a single pointer to a heap block, which holds
+/// a pointer to the table of the callable in front of the callable.
+///
+/// Every callable is allocated on the heap then, while an empty function
+/// is a null pointer. Moving the function only moves that pointer.
+/// Since no other layout shares this heap block, converting a thin function
+/// into another function, or the other way around, wraps it as callable.
+struct capacity_thin {
+  static constexpr std::size_t capacity = 0U;
+  static constexpr std::size_t alignment = alignof(void*);
+  static constexpr bool is_thin = true;
+};
+
+/// Can be passed to function_base as template argument which causes
+/// callables that are allocated on the heap to be shared between copies
+/// of the function through a reference counted block, which is allocated
+/// through the allocator of the callable.
+///
+/// Copying the function then only increments the reference count.
+/// The callable is copied on the first invocation through a non const
+/// signature while it is still shared (copy on write). Since the copy may
+/// throw, noexcept signatures are required to be const qualified.
+/// When IsAtomic is false the reference count is modified through plain
+/// operations, which is only safe if all copies are used by one thread.
+/// Unshared functions, or functions with the other kind of reference count,
+/// are wrapped as callable when they are converted into each other.
+template <typename Capacity = capacity_default, bool IsAtomic = true>
+struct capacity_shared : Capacity {
+  static constexpr bool is_shared = true;
+  static constexpr bool is_atomic = IsAtomic;
+};
+
+/// An adaptable function wrapper base for arbitrary functional types.
+///
 /// \tparam IsOwning Is true when the type erasure shall be owning the object.
 ///
 /// \tparam IsCopyable Defines whether the function is copyable or not
@@ -1764,6 +5322,27 @@ struct capacity_can_hold {
 ///   static constexpr std::size_t alignment = alignof(my_type);
 /// };
 /// ```
+///                  Optionally the type may expose `is_merged = true`
+///                  to reference both tables through a single pointer,
+///                  see capacity_merged for details, or `is_inlined = true`
+///                  to store the invokers inside the function,
+///                  see capacity_inlined for details.
+///                  Also the type may expose `is_nothrow_movable = true`
+///                  to make the function nothrow movable,
+///                  see capacity_nothrow_movable for details,
+///                  or `is_trivially_relocatable = true` to make
+///                  the function relocatable bitwise,
+///                  see capacity_trivially_relocatable for details.
+///                  The type may expose `is_shared = true` to share heap
+///                  allocated callables between copies,
+///                  see capacity_shared for details, or `is_thin = true`
+///                  to store a single pointer inside the function,
+///                  see capacity_thin for details.
+///                  The type may expose `is_strict = true` to reject
+///                  callables which don't fit at compile time,
+///                  see capacity_strict for details.
+///                  Owning functions which differ in any of these options
+///                  wrap each other as callable when they are converted.
 ///
 /// \tparam IsThrowing Defines whether the function throws an exception on
 ///                    empty function call, `std::abort` is called otherwise.
@@ -1791,6 +5370,103 @@ template <typename... Signatures>
 using unique_function = function_base<true, false, capacity_default, //
                                       true, false, Signatures...>;
 
+/// An owning copyable function wrapper for arbitrary callable types,
+/// which shares heap allocated callables between its copies.
+template <typename... Signatures>
+using shared_function = function_base<true, true, capacity_shared<>, //
+                                      true, false, Signatures...>;
+
+/// An owning function wrapper for the given set of callable types,
+/// which selects the type of the held callable through a switch on
+/// invocation instead of an indirect call.
+///
+/// It is convertible to the other function wrappers, which then hold
+/// the fu2::function_of object itself.
+using detail::function_of;
+
+/// A non owning function wrapper which is used as parameter type of
+/// functions which only sometimes store the given callable.
+///
+/// It references the callable like a fu2::function_view, such that the
+/// synchronous path never allocates, and `materialize` moves or copies
+/// the callable into a fu2::unique_function only when it is stored:
+///
+///   ```cpp
+///   void lookup(key k, fu2::function_arg<void(value)> on_miss) {
+///     if (auto* hit = cache.find(k)) {
+///       on_miss(*hit); // Called directly, nothing is allocated
+///     } else {
+///       pending.push_back(on_miss.materialize());
+///     }
+///   }
+///   ```
+template <typename... Signatures>
+using function_arg = detail::function_arg<capacity_default, Signatures...>;
+
+/// A thunk of the given signature together with the context which it is
+/// invoked with, which is returned by `raw()` of the function wrappers.
+///
+/// The thunk is a plain function pointer which takes the context as
+/// `void*` in front of the arguments of the signature, where arguments
+/// which are neither references nor trivially copyable types of up to
+/// two words are taken as rvalue reference. Thus the thunk only follows
+/// the C calling convention when all arguments are such types, and then
+/// it can be passed as callback to C interfaces directly:
+///
+///   ```cpp
+///   auto raw = fn.raw();
+///   c_library_set_callback(handle, raw.thunk, raw.context);
+///   ```
+template <typename Signature>
+using raw_function =
+    detail::type_erasure::invocation_table::raw_thunk_of<Signature>;
+
+/// Describes the buffer from which `invoke_from_buffer` invokes the given
+/// signature, which requires all arguments to be trivially copyable.
+///
+/// The decayed arguments are stored in order of the signature in their
+/// native representation, without any padding or alignment in between.
+/// `size` is the size of the buffer, `offset(index)` returns the offset
+/// of an argument and `store` stores arguments into a buffer:
+///
+///   ```cpp
+///   unsigned char buffer[fu2::buffer_layout<void(int, double)>::size];
+///   fu2::buffer_layout<void(int, double)>::store(buffer, 1, 2.0);
+///   fn.invoke_from_buffer(buffer, sizeof(buffer));
+///   ```
+template <typename Signature>
+using buffer_layout = detail::type_erasure::invocation_table::packed_layout<
+    typename detail::type_erasure::invocation_table::function_trait<
+        Signature>::arguments>;
+
+/// A signature which provides the call operator of the given signature
+/// together with `invoke_batch`, which invokes the callable with every
+/// element of a contiguous range through a single call of its thunk.
+///
+/// The loop is inlined into the thunk of every callable type, which saves
+/// one indirect call per element and lets the compiler vectorize it.
+/// Elements are the decayed argument for signatures with a single
+/// argument and a std::tuple of the decayed arguments otherwise:
+///
+///   ```cpp
+///   fu2::function<fu2::batch<int(int) const>> fn = [](int i) {
+///     return i * 2;
+///   };
+///   fn.invoke_batch(input.data(), input.size(), output.data());
+///   ```
+using detail::batch;
+
+/// An owning function wrapper for arbitrary callable types, which may be
+/// invoked by many threads concurrently while its callable is replaced.
+///
+/// Invocations and store never wait, the previous callable is destroyed
+/// by a later store or the destructor once it isn't invoked anymore.
+/// All threads invoke the same callable, therefore all signatures have
+/// to be const qualified and the callable needs to be safe for
+/// concurrent calls.
+template <typename... Signatures>
+using atomic_function = detail::atomic_function<unique_function<Signatures...>>;
+
 /// A non owning copyable function wrapper for arbitrary callable types.
 template <typename... Signatures>
 using function_view = function_base<false, true, capacity_default, //
@@ -1812,6 +5488,34 @@ using function_view = function_base<false, true, capacity_default, //
 using detail::type_erasure::invocation_table::bad_function_call;
 #endif
 
+/// Tag which constructs the callable of the given type directly inside
+/// the storage of a function.
+///
+/// This type will default to std::in_place_type_t when C++17 is available,
+/// otherwise the library provides its own type.
+using detail::in_place_type;
+using detail::in_place_type_t;
+
+/// Deduces to a true type if objects of the given type may be relocated
+/// through copying their bytes, which means a move construction followed
+/// by the destruction of the source is equivalent to a std::memcpy.
+///
+/// This is true for trivially copyable types, non owning functions
+/// and owning functions which use capacity_trivially_relocatable.
+using detail::is_trivially_relocatable;
+
+/// Relocates the given count of functions starting at first
+/// into the uninitialized storage starting at dest,
+/// after which the source functions are destroyed.
+///
+/// Functions which hold their callable on the heap or a trivially copyable
+/// callable inplace are relocated through std::memcpy, when the function
+/// type is trivially relocatable all of them are copied at once.
+/// The storage ranges must not overlap.
+///
+/// \returns A pointer behind the last relocated function in dest
+using detail::relocate_n;
+
 /// Returns a callable object, which unifies all callable objects
 /// that were passed to this function.
 ///
@@ -1828,6 +5532,84 @@ template <typename... T>
 constexpr auto overload(T&&... callables) {
   return detail::overloading::overload(std::forward<T>(callables)...);
 }
+
+/// Returns a callable which invokes the given callables in order, where
+/// every callable is invoked with the result of its predecessor and the
+/// first one with the arguments of the call.
+///
+/// The callables are stored as flat sequence inside a single object,
+/// compositions which are passed as argument are flattened into it.
+/// Callables keep their concrete type such that they can be inlined,
+/// while function wrappers are stored by value and invoked through their
+/// own thunk. Thus a chain which is assigned to a function is erased once
+/// and allocated at most once, instead of once for every nested layer:
+///
+///   ```cpp
+///   fu2::function<int(int)> chain = fu2::compose(parse, validate, handle);
+///   ```
+///
+/// \param  callables A pack of callable objects which are invoked in order.
+///
+/// \returns          A callable object which invokes the whole chain.
+template <typename... T>
+constexpr auto compose(T&&... callables) {
+  return detail::composition::compose(std::forward<T>(callables)...);
+}
+
+#if defined(FU2_HAS_CXX17_AUTO_TEMPLATE_PARAMETER)
+/// Returns a callable which invokes the given member function or function
+/// pointer with the given object and arguments in front of the arguments
+/// it is invoked with.
+///
+/// The method is passed as template argument and isn't stored inside the
+/// callable, so the thunk of a function calls it directly. The callable
+/// only holds the object and the bound arguments, a bound object pointer
+/// without bound arguments thus fits into every internal capacity.
+/// A member function pointer which is only known at runtime is twice
+/// as large as an object pointer and isn't accepted for this reason:
+///
+///   ```cpp
+///   fu2::function<void(int)> handler = fu2::bind_front<&widget::resize>(this);
+///   ```
+///
+/// \param  object The object or pointer on which the method is invoked.
+/// \param  bound  The arguments which are passed in front of the others.
+///
+/// \returns       A callable object which invokes the method.
+template <auto Method, typename Object, typename... Bound>
+constexpr auto bind_front(Object&& object, Bound&&... bound) {
+  using holder_t =
+      detail::binding::constant_method<decltype(Method), Method>;
+
+  return detail::binding::bound_front<holder_t, std::decay_t<Object>,
+                                      std::decay_t<Bound>...>(
+      holder_t{}, std::forward<Object>(object), std::forward<Bound>(bound)...);
+}
+#endif // FU2_HAS_CXX17_AUTO_TEMPLATE_PARAMETER
+
+/// Invokes the given owning function with the given arguments, where the
+/// held callable is invoked directly if it is of one of the types T,
+/// which are tried in order, and through the erased call otherwise.
+///
+/// This allows the compiler to inline the expected callables at call
+/// sites which are dominated by a few types:
+///
+///   ```cpp
+///   fu2::function<int(int)> fn = add_one{};
+///   int result = fu2::invoke_speculative<add_one, multiply>(fn, 1);
+///   ```
+///
+/// \param  function The function which is invoked.
+/// \param  args     The arguments which are passed to the callable.
+///
+/// \returns         The result of the invocation of the function.
+template <typename... T, typename Function, typename... Args>
+decltype(auto) invoke_speculative(Function&& function, Args&&... args) {
+  using result_t = decltype(std::declval<Function>()(std::declval<Args>()...));
+
+  return detail::speculation::invoker<result_t, T...>::invoke(
+      std::forward<Function>(function), std::forward<Args>(args)...);
+}
 } // namespace fu2
 
 namespace std{
@@ -4,6 +4,8 @@
 //       (See accompanying file LICENSE_1_0.txt or copy at
 //             http://www.boost.org/LICENSE_1_0.txt)
 
+#include <vector>
+
 #include "function2-test.hpp"
 
 namespace {
@@ -33,6 +35,47 @@ public:
   }
 };
 
+/// Functor which counts how often it was moved
+class MoveCountingFunctor {
+  std::size_t* moves;
+
+public:
+  explicit MoveCountingFunctor(std::size_t* moves_) : moves(moves_) {
+  }
+  MoveCountingFunctor(MoveCountingFunctor const&) = default;
+  MoveCountingFunctor(MoveCountingFunctor&& right) : moves(right.moves) {
+    ++*moves;
+  }
+
+  std::size_t operator()() const {
+    return *moves;
+  }
+};
+
+/// Functor which counts how often it was copied, and which is too large
+/// to be stored inplace
+class CopyCountingFunctor {
+  void* padding[8]{};
+  std::size_t* copies;
+  std::size_t value = 0;
+
+public:
+  explicit CopyCountingFunctor(std::size_t* copies_) : copies(copies_) {
+  }
+  CopyCountingFunctor(CopyCountingFunctor&&) = default;
+  CopyCountingFunctor(CopyCountingFunctor const& right)
+      : copies(right.copies), value(right.value) {
+    ++*copies;
+  }
+
+  std::size_t operator()() {
+    return ++value;
+  }
+  std::size_t operator()(std::size_t offset) const {
+    return value + offset;
+  }
+};
+
 /// Functor which returns it's shared count
 class SharedCountFunctor {
   std::shared_ptr<std::size_t> state = std::make_shared<std::size_t>(0);
@@ -219,3 +262,120 @@ TYPED_TEST(CopyableCopyAssignConstructTests, CopyStateOnCopyAssign) {
     EXPECT_EQ(right(), 4UL);
   }
 }
+
+ALL_LEFT_TYPED_TEST_CASE(AllInPlaceConstructTests)
+
+TYPED_TEST(AllInPlaceConstructTests, AreInPlaceConstructible) {
+  typename TestFixture::template left_t<std::size_t()> left(
+      fu2::in_place_type<SharedCountFunctor>);
+  EXPECT_EQ(left(), 1UL);
+}
+
+TYPED_TEST(AllInPlaceConstructTests, AreEmplaceable) {
+  typename TestFixture::template left_t<std::size_t()> left;
+  SharedCountFunctor& functor = left.template emplace<SharedCountFunctor>();
+  EXPECT_EQ(functor(), 1UL);
+  EXPECT_EQ(left(), 1UL);
+
+  left.template emplace<SharedCountFunctor>();
+  EXPECT_EQ(left(), 1UL);
+}
+
+TYPED_TEST(AllInPlaceConstructTests, AreNotMovedOnInPlaceConstruct) {
+  std::size_t moves = 0;
+  typename TestFixture::template left_t<std::size_t()> left(
+      fu2::in_place_type<MoveCountingFunctor>, &moves);
+  EXPECT_EQ(left(), 0UL);
+
+  left.template emplace<MoveCountingFunctor>(&moves);
+  EXPECT_EQ(left(), 0UL);
+}
+
+COPYABLE_LEFT_TYPED_TEST_CASE(CopyableRelocateTests)
+
+TYPED_TEST(CopyableRelocateTests, KeepStatesOnRelocate) {
+  using left_t = typename TestFixture::template left_t<std::size_t()>;
+  std::vector<left_t> functions;
+  for (std::size_t i = 0; i < 32; ++i) {
+    functions.emplace_back([i] { return i; });
+  }
+  for (std::size_t i = 0; i < 32; ++i) {
+    EXPECT_EQ(functions[i](), i);
+  }
+
+  left_t moved = std::move(functions[7]);
+  EXPECT_FALSE(functions[7]);
+  EXPECT_EQ(moved(), 7UL);
+
+  left_t copied = moved;
+  EXPECT_TRUE(moved);
+  EXPECT_EQ(copied(), 7UL);
+
+  left_t empty;
+  copied = empty;
+  EXPECT_FALSE(copied);
+}
+
+TYPED_TEST(CopyableRelocateTests, DestroyNonTrivialStates) {
+  auto counter = std::make_shared<std::size_t>(0);
+  {
+    typename TestFixture::template left_t<std::size_t()> left = [counter] {
+      return *counter;
+    };
+    auto copied = left;
+    EXPECT_EQ(counter.use_count(), 3);
+    auto moved = std::move(left);
+    EXPECT_EQ(counter.use_count(), 3);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(SharedFunctionTests, CopyOnWrite) {
+  std::size_t copies = 0;
+  allocation_count() = 0;
+
+  fu2::shared_function<std::size_t(), std::size_t(std::size_t) const> left;
+  left.assign(CopyCountingFunctor{&copies},
+              counting_allocator<CopyCountingFunctor>{});
+  EXPECT_EQ(allocation_count(), 1U);
+
+  auto right = left;
+  EXPECT_EQ(copies, 0UL);
+  EXPECT_EQ(right(1), 1UL);
+  EXPECT_EQ(copies, 0UL);
+
+  // The shared callable is copied before it is modified
+  EXPECT_EQ(right(), 1UL);
+  EXPECT_EQ(copies, 1UL);
+  EXPECT_EQ(allocation_count(), 2U);
+  EXPECT_EQ(left(1), 1UL);
+
+  // The callable isn't shared anymore
+  EXPECT_EQ(left(), 1UL);
+  EXPECT_EQ(right(), 2UL);
+  EXPECT_EQ(copies, 1UL);
+}
+
+TEST(SharedFunctionTests, ReleaseTheLastReference) {
+  using shared_t = fu2::function_base<
+      true, true, fu2::capacity_shared<fu2::capacity_default, false>, true,
+      false, int(int) const>;
+
+  auto counter = std::make_shared<int>(4);
+  shared_t left = [counter, functor = large_add_functor{{}, 1}](int value) {
+    return functor(value) + *counter;
+  };
+  {
+    std::vector<shared_t> copies(4, left);
+    EXPECT_EQ(counter.use_count(), 2);
+    for (auto const& copy : copies) {
+      EXPECT_EQ(copy(0), 5);
+    }
+  }
+  shared_t moved = std::move(left);
+  EXPECT_EQ(counter.use_count(), 2);
+  EXPECT_EQ(moved(0), 5);
+
+  moved = nullptr;
+  EXPECT_EQ(counter.use_count(), 1);
+}
@@ -0,0 +1,327 @@
+
+//  Copyright 2015-2020 Denis Blank <denis.blank at outlook dot com>
+//     Distributed under the Boost Software License, Version 1.0
+//       (See accompanying file LICENSE_1_0.txt or copy at
+//             http://www.boost.org/LICENSE_1_0.txt)
+
+#include <vector>
+
+#include "function2-test.hpp"
+
+namespace {
+/// Functor whose move constructor may throw
+struct ThrowingMoveFunctor {
+  ThrowingMoveFunctor() = default;
+  ThrowingMoveFunctor(ThrowingMoveFunctor const&) = default;
+  ThrowingMoveFunctor(ThrowingMoveFunctor&&) noexcept(false) {
+  }
+
+  int operator()(int value) const {
+    return value;
+  }
+};
+} // namespace
+
+TEST(CapacityTests, OverAlignedCallablesAreStoredInplace) {
+  using fun_t = fu2::function_base<true, true, fu2::capacity_fixed<64, 32>,
+                                   false, true, int(int)>;
+
+  allocation_count() = 0;
+  fun_t fn;
+  fn.assign(over_aligned_add_functor{1},
+            counting_allocator<over_aligned_add_functor>{});
+  ASSERT_EQ(fn(1), 2);
+
+  fun_t moved = std::move(fn);
+  ASSERT_EQ(moved(1), 2);
+  fun_t copied = moved;
+  ASSERT_EQ(copied(1), 2);
+  ASSERT_EQ(allocation_count(), 0U);
+}
+
+TEST(CapacityTests, MergedTablesIncreaseTheCapacity) {
+  using fun_t = fu2::function_base<true, true, fu2::capacity_merged<>, false,
+                                   true, int(int)>;
+  ASSERT_EQ(sizeof(fun_t), fu2::detail::object_size::value);
+
+  allocation_count() = 0;
+  fun_t fn;
+  fn.assign(padded_add_functor<2>{{}, 1},
+            counting_allocator<padded_add_functor<2>>{});
+  ASSERT_EQ(fn(1), 2);
+  ASSERT_EQ(allocation_count(), 0U);
+}
+
+TEST(CapacityTests, MergedFunctionsAreWrappedOnConversion) {
+  using merged_t = fu2::function_base<true, true, fu2::capacity_merged<>,
+                                      true, false, int(int) const>;
+
+  merged_t merged = add_functor{1};
+  fu2::function<int(int) const> fn = merged;
+  ASSERT_EQ(fn(1), 2);
+  ASSERT_NE(fn.target<merged_t>(), nullptr);
+
+  merged_t converted = fn;
+  ASSERT_EQ(converted(1), 2);
+  ASSERT_NE(converted.target<fu2::function<int(int) const>>(), nullptr);
+}
+
+TEST(CapacityTests, InlinedInvokersAreStoredInsideTheFunction) {
+  using fun_t = fu2::function_base<true, true, fu2::capacity_inlined<>, false,
+                                   true, int(int), int(int, int)>;
+  ASSERT_GT(sizeof(fun_t), fu2::detail::object_size::value);
+
+  fun_t fn = [](auto... args) { return int(sizeof...(args)); };
+  fun_t copied = fn;
+  ASSERT_EQ(copied(0), 1);
+  ASSERT_EQ(copied(0, 0), 2);
+
+  // Functions which reference a static table wrap the inlined function
+  fu2::function<int(int), int(int, int)> wrapped = copied;
+  ASSERT_NE(wrapped.target<fun_t>(), nullptr);
+  ASSERT_EQ(wrapped(0, 0), 2);
+}
+
+TEST(CapacityTests, ReassignmentReusesTheAllocationOfTheSameType) {
+  fu2::unique_function<int(int)> fn;
+  allocation_count() = 0;
+  for (int i = 0; i < 8; ++i) {
+    fn.assign(large_add_functor{{}, i},
+              counting_allocator<large_add_functor>{});
+    ASSERT_EQ(fn(0), i);
+  }
+  ASSERT_EQ(allocation_count(), 1U);
+}
+
+TEST(CapacityTests, ReserveAvoidsAllocations) {
+  fu2::unique_function<int(int)> fn;
+  allocation_count() = 0;
+  fn.reserve(sizeof(large_add_functor) + sizeof(void*));
+  ASSERT_FALSE(fn);
+
+  fn.assign(large_add_functor{{}, 1}, counting_allocator<large_add_functor>{});
+  ASSERT_EQ(fn(0), 1);
+
+  fn = nullptr;
+  ASSERT_FALSE(fn);
+
+  fn.assign([x = large_add_functor{{}, 2}](int value) { return x(value); },
+            counting_allocator<large_add_functor>{});
+  ASSERT_EQ(fn(0), 2);
+
+  fu2::unique_function<int(int)> moved = std::move(fn);
+  ASSERT_FALSE(fn);
+  ASSERT_EQ(moved(0), 2);
+  ASSERT_EQ(allocation_count(), 0U);
+}
+
+TEST(CapacityTests, ReserveIsBypassedByStatefulAllocators) {
+  using allocator_t = counting_allocator<large_add_functor, true>;
+
+  fu2::unique_function<int(int)> fn;
+  fn.reserve(4 * (sizeof(large_add_functor) + sizeof(allocator_t)));
+
+  allocation_count() = 0;
+  fn.assign(large_add_functor{{}, 1}, allocator_t{});
+  ASSERT_EQ(fn(0), 1);
+  ASSERT_EQ(allocation_count(), 1U);
+}
+
+TEST(CapacityTests, ReserveKeepsSmallCallablesInplace) {
+  fu2::unique_function<int(int)> fn;
+  fn.reserve(sizeof(large_add_functor));
+
+  fn = add_functor{3};
+  ASSERT_EQ(fn(0), 3);
+
+  auto target = reinterpret_cast<char const*>(fn.target<add_functor>());
+  auto begin = reinterpret_cast<char const*>(&fn);
+  ASSERT_TRUE((target >= begin) && (target < begin + sizeof(fn)));
+}
+
+TEST(CapacityTests, NothrowMovableCapacityIsNothrowMovable) {
+  using fun_t = fu2::function_base<true, true,
+                                   fu2::capacity_nothrow_movable<>, true,
+                                   false, int(int)>;
+  static_assert(std::is_nothrow_move_constructible<fun_t>::value, "");
+  static_assert(std::is_nothrow_move_assignable<fun_t>::value, "");
+
+  std::vector<fun_t> functions;
+  for (int i = 0; i < 16; ++i) {
+    functions.emplace_back(ThrowingMoveFunctor{});
+    functions.emplace_back(add_functor{i});
+  }
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_EQ(functions[i * 2](1), 1);
+    ASSERT_EQ(functions[i * 2 + 1](1), i + 1);
+  }
+
+  // Functions which allocate under other rules are wrapped
+  fu2::unique_function<int(int)> wrapped = std::move(functions.back());
+  ASSERT_NE(wrapped.target<fun_t>(), nullptr);
+  ASSERT_EQ(wrapped(1), 16);
+}
+
+TEST(CapacityTests, NothrowMovableCapacityNeverAllocatesOnMove) {
+  using fun_t = fu2::function_base<
+      true, true, fu2::capacity_nothrow_movable<fu2::capacity_fixed<64, 16>>,
+      true, false, int(int)>;
+  static_assert(std::is_nothrow_move_constructible<fun_t>::value, "");
+
+  allocation_count() = 0;
+  fun_t fn;
+  fn.assign(over_aligned_add_functor{1},
+            counting_allocator<over_aligned_add_functor>{});
+  ASSERT_EQ(allocation_count(), 1U);
+
+  fun_t moved = std::move(fn);
+  fun_t assigned;
+  assigned = std::move(moved);
+  ASSERT_EQ(allocation_count(), 1U);
+  ASSERT_EQ(assigned(1), 2);
+}
+
+TEST(CapacityTests, TriviallyRelocatableCapacityIsRelocatedBitwise) {
+  using fun_t = fu2::function_base<true, true,
+                                   fu2::capacity_trivially_relocatable<>,
+                                   true, false, int()>;
+  static_assert(fu2::is_trivially_relocatable<fun_t>::value, "");
+  static_assert(fu2::is_trivially_relocatable<fu2::function_view<int()>>::value,
+                "");
+  static_assert(!fu2::is_trivially_relocatable<fu2::function<int()>>::value,
+                "");
+
+  auto counter = std::make_shared<int>(7);
+  fun_t functions[2] = {[counter] { return *counter; }, [] { return 3; }};
+
+  alignas(fun_t) unsigned char storage[sizeof(functions)];
+  auto dest = reinterpret_cast<fun_t*>(storage);
+  ASSERT_EQ(fu2::relocate_n(functions, 2, dest), dest + 2);
+  ASSERT_EQ(dest[0](), 7);
+  ASSERT_EQ(dest[1](), 3);
+  ASSERT_EQ(counter.use_count(), 2);
+
+  // The source functions are destroyed now
+  new (functions) fun_t[2]{};
+  dest[0].~fun_t();
+  dest[1].~fun_t();
+  ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(CapacityTests, RelocateMovesNonTrivialObjects) {
+  using fun_t = fu2::unique_function<int(int)>;
+
+  auto counter = std::make_shared<int>(7);
+  std::vector<fun_t> source;
+  source.emplace_back([counter](int value) { return value + *counter; });
+  source.emplace_back(add_functor{3});
+  source.emplace_back(large_add_functor{{}, 5});
+
+  alignas(fun_t) unsigned char storage[sizeof(fun_t) * 3];
+  auto dest = reinterpret_cast<fun_t*>(storage);
+  fu2::relocate_n(source.data(), 3, dest);
+  ASSERT_EQ(dest[0](0), 7);
+  ASSERT_EQ(dest[1](0), 3);
+  ASSERT_EQ(dest[2](0), 5);
+  ASSERT_EQ(counter.use_count(), 2);
+
+  // The source functions are destroyed now
+  for (auto& fn : source) {
+    new (&fn) fun_t();
+  }
+  for (std::size_t i = 0; i < 3; ++i) {
+    dest[i].~fun_t();
+  }
+  ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(CapacityTests, ThinFunctionsStoreASinglePointer) {
+  using fun_t = fu2::function_base<true, true, fu2::capacity_thin, true, false,
+                                   int(int), int(int, int) const>;
+  ASSERT_EQ(sizeof(fun_t), sizeof(void*));
+  ASSERT_TRUE(fu2::is_trivially_relocatable<fun_t>::value);
+
+  fun_t fn;
+  ASSERT_FALSE(fn);
+  ASSERT_EQ(*reinterpret_cast<void* const*>(&fn), nullptr);
+
+  fn = [](auto... args) { return int(sizeof...(args)); };
+  fun_t copied = fn;
+  ASSERT_EQ(copied(0), 1);
+  ASSERT_EQ(copied(0, 0), 2);
+
+  fun_t moved = std::move(fn);
+  ASSERT_FALSE(fn);
+  ASSERT_EQ(moved(0), 1);
+
+  // Other layouts wrap the thin function
+  fu2::function<int(int), int(int, int) const> wrapped = std::move(moved);
+  ASSERT_NE(wrapped.target<fun_t>(), nullptr);
+  ASSERT_EQ(wrapped(0, 0), 2);
+}
+
+TEST(CapacityTests, CompactFunctionsStoreOneWordInplace) {
+  using fun_t = fu2::function_base<true, true, fu2::capacity_compact, false,
+                                   true, int(), int(int) const>;
+  ASSERT_EQ(sizeof(fun_t), 2 * sizeof(void*));
+
+  int value = 12345;
+  int* ptr = &value;
+  allocation_count() = 0;
+  fun_t fn;
+  fn.assign([ptr](auto... args) { return *ptr + int(sizeof...(args)); },
+            counting_allocator<int>{});
+  ASSERT_EQ(allocation_count(), 0U);
+  ASSERT_EQ(fn(), 12345);
+  ASSERT_EQ(fn(0), 12346);
+
+  fn = [functor = padded_add_functor<2>{{}, 12345}](auto... args) {
+    return functor(int(sizeof...(args)));
+  };
+  fun_t copied = fn;
+  ASSERT_EQ(copied(), 12345);
+  ASSERT_EQ(copied(0), 12346);
+}
+
+TEST(CapacityTests, StrictFunctionsStoreAllCallablesInplace) {
+  using fun_t =
+      fu2::function_base<true, true, fu2::capacity_strict<3 * sizeof(void*)>,
+                         false, true, int(int)>;
+
+  fun_t fn = padded_add_functor<2>{{}, 12345};
+  ASSERT_EQ(fn(0), 12345);
+
+  allocation_count() = 0;
+  fn.assign(padded_add_functor<2>{{}, 12345},
+            counting_allocator<padded_add_functor<2>>{});
+  fun_t copied = fn;
+  fun_t moved = std::move(fn);
+  ASSERT_EQ(allocation_count(), 0U);
+  ASSERT_EQ(copied(0), 12345);
+  ASSERT_EQ(moved(0), 12345);
+
+  // Rejected at compile time:
+  // fn = large_add_functor{};
+}
+
+TEST(CapacityTests, StatelessCallablesNeverAllocate) {
+  using fun_t = fu2::function_base<true, true, fu2::capacity_none, false,
+                                   true, int(int) const>;
+
+  allocation_count() = 0;
+  fun_t fn;
+  fn.assign([](int value) { return value * 2; },
+            counting_allocator<int, true>{});
+  ASSERT_EQ(fn(2), 4);
+
+  fun_t copied = fn;
+  ASSERT_EQ(copied(3), 6);
+
+  fun_t moved = std::move(copied);
+  ASSERT_FALSE(copied);
+  ASSERT_EQ(moved(4), 8);
+
+  fn = nullptr;
+  ASSERT_EQ(moved(5), 10);
+  ASSERT_EQ(allocation_count(), 0U);
+}
@@ -54,6 +54,37 @@ template <typename Fn, bool Throwing = true, bool Owning = true,
           typename... Additional>
 using copyable_512_sfo =
     short_def<Fn, true, 512, Throwing, Owning, Additional...>;
+/// Functions which merge their tables into a single static table
+template <typename Fn, bool Throwing = true, bool Owning = true,
+          typename... Additional>
+using unique_merged =
+    fu2::function_base<Owning, false, fu2::capacity_merged<>, Throwing, false,
+                       Fn, Additional...>;
+template <typename Fn, bool Throwing = true, bool Owning = true,
+          typename... Additional>
+using copyable_merged =
+    fu2::function_base<Owning, true, fu2::capacity_merged<>, Throwing, false,
+                       Fn, Additional...>;
+/// Functions which store their invokers inside the function object
+template <typename Fn, bool Throwing = true, bool Owning = true,
+          typename... Additional>
+using unique_inlined =
+    fu2::function_base<Owning, false, fu2::capacity_inlined<>, Throwing, false,
+                       Fn, Additional...>;
+template <typename Fn, bool Throwing = true, bool Owning = true,
+          typename... Additional>
+using copyable_inlined =
+    fu2::function_base<Owning, true, fu2::capacity_inlined<>, Throwing, false,
+                       Fn, Additional...>;
+/// Functions which only store a pointer to a heap block
+template <typename Fn, bool Throwing = true, bool Owning = true,
+          typename... Additional>
+using unique_thin = fu2::function_base<Owning, false, fu2::capacity_thin,
+                                       Throwing, false, Fn, Additional...>;
+template <typename Fn, bool Throwing = true, bool Owning = true,
+          typename... Additional>
+using copyable_thin = fu2::function_base<Owning, true, fu2::capacity_thin,
+                                         Throwing, false, Fn, Additional...>;
 /// std::function
 template <typename Fn, bool Throwing = true, bool Owning = true, typename...>
 using std_function = std::function<Fn>;
@@ -116,7 +147,8 @@ struct FunctionTesterBase : Provider, testing::Test {};
 /// The functions are only capable of wrapping a copyable functor.
 using CopyableLeftExpandedTypes =
     std::tuple<LeftType<copyable_no_sfo>, LeftType<copyable_256_sfo>,
-               LeftType<copyable_512_sfo>>;
+               LeftType<copyable_512_sfo>, LeftType<copyable_merged>,
+               LeftType<copyable_inlined>, LeftType<copyable_thin>>;
 
 /// Declares a typed test case where all possibilities of copyable
 /// functions are used as left parameter.
@@ -129,7 +161,8 @@ using CopyableLeftExpandedTypes =
 /// The functions are capable of wrapping a unique functor.
 using UniqueLeftExpandedTypes =
     std::tuple<LeftType<unique_no_sfo>, LeftType<unique_256_sfo>,
-               LeftType<unique_512_sfo>>;
+               LeftType<unique_512_sfo>, LeftType<unique_merged>,
+               LeftType<unique_inlined>, LeftType<unique_thin>>;
 
 /// Declares a typed test case where all possibilities of copyable sfo
 /// functions are used as left parameter.
@@ -173,7 +206,19 @@ using CopyableLeftRightExpandedTypes = std::tuple<
     LeftRightType<std_function, copyable_no_sfo>,
     LeftRightType<std_function, copyable_256_sfo>,
     LeftRightType<std_function, copyable_512_sfo>,
-    LeftRightType<std_function, std_function>>;
+    LeftRightType<std_function, std_function>,
+    // copyable_merged = ?
+    LeftRightType<copyable_merged, copyable_merged>,
+    LeftRightType<copyable_merged, copyable_256_sfo>,
+    LeftRightType<copyable_256_sfo, copyable_merged>,
+    // copyable_inlined = ?
+    LeftRightType<copyable_inlined, copyable_inlined>,
+    LeftRightType<copyable_inlined, copyable_merged>,
+    LeftRightType<copyable_256_sfo, copyable_inlined>,
+    // copyable_thin = ?
+    LeftRightType<copyable_thin, copyable_thin>,
+    LeftRightType<copyable_thin, copyable_256_sfo>,
+    LeftRightType<copyable_256_sfo, copyable_thin>>;
 
 /// Declares a typed test case where all possibilities of copyable sfo
 /// functions are used as left and right parameter,
@@ -198,7 +243,19 @@ using UniqueLeftRightExpandedTypes = std::tuple<
     // unique_512_sfo = ?
     LeftRightType<unique_512_sfo, unique_no_sfo>,
     LeftRightType<unique_512_sfo, unique_256_sfo>,
-    LeftRightType<unique_512_sfo, unique_512_sfo>>;
+    LeftRightType<unique_512_sfo, unique_512_sfo>,
+    // unique_merged = ?
+    LeftRightType<unique_merged, unique_merged>,
+    LeftRightType<unique_merged, unique_256_sfo>,
+    LeftRightType<unique_256_sfo, unique_merged>,
+    // unique_inlined = ?
+    LeftRightType<unique_inlined, unique_inlined>,
+    LeftRightType<unique_inlined, unique_merged>,
+    LeftRightType<unique_256_sfo, unique_inlined>,
+    // unique_thin = ?
+    LeftRightType<unique_thin, unique_thin>,
+    LeftRightType<unique_thin, unique_256_sfo>,
+    LeftRightType<unique_256_sfo, unique_thin>>;
 
 /// Declares a typed test case where all possibilities of unique sfo
 /// functions are used as left and right parameter,
@@ -238,6 +295,85 @@ using AllLeftRightExpandedTypes =
 #define ALL_LEFT_RIGHT_TYPED_TEST_CASE(TEST_CASE_NAME)                         \
   DEFINE_FUNCTION_TEST_CASE(TEST_CASE_NAME, AllLeftRightExpandedTypes)
 
+/// Returns the count of allocations which were made through
+/// a counting_allocator of any type
+inline std::size_t& allocation_count() noexcept {
+  static std::size_t count = 0;
+  return count;
+}
+
+/// An allocator which counts its allocations, which allows to check
+/// whether a function allocates memory for the callables it stores.
+///
+/// The allocator is empty unless IsStateful is true, then it carries
+/// state like an arena allocator, which is copied together with it.
+template <typename T, bool IsStateful = false>
+struct counting_allocator : std::allocator<T> {
+  counting_allocator() = default;
+  template <typename O>
+  counting_allocator(counting_allocator<O, IsStateful> const&) noexcept {
+  }
+
+  template <typename M>
+  struct rebind {
+    using other = counting_allocator<M, IsStateful>;
+  };
+
+  T* allocate(std::size_t n) {
+    ++allocation_count();
+    return std::allocator<T>::allocate(n);
+  }
+};
+template <typename T>
+struct counting_allocator<T, true> : counting_allocator<T, false> {
+  using is_always_equal = std::false_type;
+
+  void* state[4]{};
+
+  counting_allocator() = default;
+  template <typename O>
+  counting_allocator(counting_allocator<O, true> const&) noexcept {
+  }
+
+  template <typename M>
+  struct rebind {
+    using other = counting_allocator<M, true>;
+  };
+};
+
+/// A callable which adds its offset to the given value
+struct add_functor {
+  int offset;
+
+  int operator()(int value) const {
+    return value + offset;
+  }
+};
+
+/// A callable which adds its offset to the given value, which is padded
+/// by the given count of pointers to control where it is stored
+template <std::size_t Padding>
+struct padded_add_functor {
+  void* padding[Padding];
+  int offset;
+
+  int operator()(int value) const {
+    return value + offset;
+  }
+};
+/// A padded_add_functor which never fits into the default capacity
+using large_add_functor = padded_add_functor<8>;
+
+/// A callable which adds its offset to the given value, which requires
+/// an alignment that is stricter than the alignment of a pointer
+struct alignas(32) over_aligned_add_functor {
+  int offset;
+
+  int operator()(int value) const {
+    return value + offset;
+  }
+};
+
 template <typename T, typename... Args>
 std::unique_ptr<T> make_unique(Args&&... args) {
   return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
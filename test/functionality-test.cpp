@@ -4,6 +4,11 @@
 //       (See accompanying file LICENSE_1_0.txt or copy at
 //             http://www.boost.org/LICENSE_1_0.txt)
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "function2-test.hpp"
 
 namespace {
@@ -49,6 +54,49 @@ struct RValueProvider {
     return true;
   }
 };
+
+/// Argument which counts how often it was moved
+struct MoveCountingArgument {
+  std::size_t* moves;
+
+  explicit MoveCountingArgument(std::size_t* moves_) : moves(moves_) {
+  }
+  MoveCountingArgument(MoveCountingArgument&& right) : moves(right.moves) {
+    ++*moves;
+  }
+};
+
+/// Argument which is passed through registers
+struct SmallArgument {
+  int left;
+  int right;
+};
+
+int Twice(int value) {
+  return value * 2;
+}
+
+std::string Append(std::string value, std::string const& suffix) {
+  return value + suffix;
+}
+
+/// Invokes the given callback like a C library would do
+int InvokeCCallback(int (*callback)(void*, int), void* context, int value) {
+  return callback(context, value);
+}
+
+/// Functor which returns a different value for every reference qualifier
+struct QualifiedFunctor {
+  int operator()() & {
+    return 1;
+  }
+  int operator()() const& {
+    return 2;
+  }
+  int operator()() && {
+    return 3;
+  }
+};
 } // namespace
 
 ALL_LEFT_TYPED_TEST_CASE(AllSingleMoveAssignConstructTests)
@@ -194,3 +242,455 @@ TYPED_TEST(AllSingleMoveAssignConstructTests, AcceptClassMethodPointers) {
 
   EXPECT_TRUE(left(&my_class));*/
 }
+
+TYPED_TEST(AllSingleMoveAssignConstructTests, MoveByValueArgumentsOnce) {
+  typename TestFixture::template left_t<std::size_t(MoveCountingArgument)>
+      left = [](MoveCountingArgument arg) { return *arg.moves; };
+
+  std::size_t moves = 0;
+  EXPECT_EQ(left(MoveCountingArgument(&moves)), 1UL);
+}
+
+TYPED_TEST(AllSingleMoveAssignConstructTests, PassSmallArgumentsByValue) {
+  namespace invocation_table = fu2::detail::type_erasure::invocation_table;
+  static_assert(std::is_same<invocation_table::thunk_arg_t<SmallArgument>,
+                             SmallArgument>::value,
+                "Small trivial arguments have to be passed by value!");
+  static_assert(std::is_same<invocation_table::thunk_arg_t<std::string>,
+                             std::string&&>::value,
+                "Non trivial arguments have to be passed by reference!");
+
+  typename TestFixture::template left_t<int(SmallArgument)> left =
+      [](SmallArgument arg) { return arg.left + arg.right; };
+  EXPECT_EQ(left(SmallArgument{1, 2}), 3);
+}
+
+TEST(AtomicFunctionTests, IsReplacedWhileInvoked) {
+  fu2::atomic_function<int() const> fn([] { return 0; });
+  ASSERT_TRUE(fn);
+
+  std::atomic<bool> done(false);
+  std::atomic<bool> valid(true);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!done) {
+        int const value = fn();
+        if ((value < 0) || (value > 64)) {
+          valid = false;
+        }
+      }
+    });
+  }
+
+  std::vector<std::weak_ptr<int>> previous;
+  for (int i = 1; i <= 64; ++i) {
+    auto value = std::make_shared<int>(i);
+    previous.push_back(value);
+    fn.store([value] { return *value; });
+    value.reset();
+    EXPECT_FALSE(previous.back().expired());
+  }
+
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  ASSERT_TRUE(valid);
+  ASSERT_EQ(fn(), 64);
+
+  // Without readers a store destroys all previous callables
+  fn.store([] { return 0; });
+  for (auto const& callable : previous) {
+    ASSERT_TRUE(callable.expired());
+  }
+}
+
+TEST(AtomicFunctionTests, StoreDefersTheDestructionOfRunningCallables) {
+  fu2::atomic_function<int() const> fn;
+  auto value = std::make_shared<int>(1);
+  std::weak_ptr<int> running = value;
+
+  // The callable replaces itself while it is invoked
+  fn.store([&fn, value] {
+    fn.store([] { return 2; });
+    return *value;
+  });
+  value.reset();
+
+  ASSERT_EQ(fn(), 1);
+  ASSERT_FALSE(running.expired());
+  ASSERT_EQ(fn(), 2);
+
+  fn.store([] { return 3; });
+  ASSERT_TRUE(running.expired());
+  ASSERT_EQ(fn(), 3);
+}
+
+TEST(FunctionOfTests, HoldsOneOfTheGivenTypes) {
+  auto counter = std::make_shared<int>(3);
+  auto multiply = [counter](int value) { return value * *counter; };
+  using fun_t =
+      fu2::function_of<int(int) const, add_functor, decltype(multiply)>;
+
+  fun_t fn;
+  ASSERT_FALSE(fn);
+  ASSERT_EQ(fn.index(), 2U);
+#if !defined(FU2_HAS_DISABLED_EXCEPTIONS)
+  ASSERT_THROW(fn(1), fu2::bad_function_call);
+#endif
+
+  fn = add_functor{2};
+  ASSERT_EQ(fn.index(), 0U);
+  ASSERT_EQ(fn(1), 3);
+
+  fn = multiply;
+  ASSERT_EQ(fn.index(), 1U);
+  ASSERT_EQ(fn(2), 6);
+  ASSERT_EQ(counter.use_count(), 3);
+
+  fun_t copied = fn;
+  ASSERT_EQ(copied(3), 9);
+  ASSERT_EQ(counter.use_count(), 4);
+
+  fun_t moved = std::move(copied);
+  ASSERT_FALSE(copied);
+  ASSERT_EQ(moved(4), 12);
+
+  // Converts into an open function
+  fu2::function<int(int) const> open = moved;
+  ASSERT_EQ(open(5), 15);
+
+  fn = nullptr;
+  moved = nullptr;
+  open = nullptr;
+  ASSERT_EQ(counter.use_count(), 2);
+}
+
+TEST(FunctionOfTests, PropagatesCopyAndMoveTraits) {
+  auto owned = std::make_unique<int>(4);
+  auto move_only = [owned = std::move(owned)](int value) {
+    return value + *owned;
+  };
+  using move_only_t = fu2::function_of<int(int), decltype(move_only)>;
+  using copyable_t = fu2::function_of<int(int) const, add_functor>;
+
+  static_assert(!std::is_copy_constructible<move_only_t>::value, "");
+  static_assert(!std::is_copy_assignable<move_only_t>::value, "");
+  static_assert(std::is_nothrow_move_constructible<move_only_t>::value, "");
+  static_assert(std::is_nothrow_move_assignable<move_only_t>::value, "");
+  static_assert(std::is_copy_constructible<copyable_t>::value, "");
+  static_assert(std::is_nothrow_move_constructible<copyable_t>::value, "");
+
+  std::vector<move_only_t> functions;
+  functions.emplace_back(std::move(move_only));
+  functions.emplace_back();
+  functions.reserve(16);
+  ASSERT_EQ(functions.front()(1), 5);
+  ASSERT_FALSE(functions.back());
+}
+
+TEST(FunctionPointerTests, AreInvokedThroughTheirOwnThunk) {
+  fu2::function<int(int)> fn = Twice;
+  ASSERT_EQ(fn(2), 4);
+
+  fu2::unique_function<int(int) const, int(int)> multi = &Twice;
+  ASSERT_EQ(multi(3), 6);
+  ASSERT_EQ(static_cast<decltype(multi) const&>(multi)(4), 8);
+
+  fu2::function_view<int(int)> view = &Twice;
+  ASSERT_EQ(view(5), 10);
+
+  fu2::function<std::string(std::string, std::string const&)> concat = Append;
+  ASSERT_EQ(concat("fu", "2"), "fu2");
+
+  fu2::function_view<std::string(std::string, std::string const&)> concat_view =
+      &Append;
+  ASSERT_EQ(concat_view("fu", "2"), "fu2");
+
+  // The dedicated thunk is independent of the allocator
+  fu2::function<int(int)> allocated;
+  allocated.assign(&Twice, std::allocator<int>{});
+  ASSERT_EQ(allocated(6), 12);
+  auto raw = allocated.raw();
+  ASSERT_EQ(raw.thunk(raw.context, 7), 14);
+
+  // Callables which aren't plain function pointers use their thunk
+  fn = [](int value) { return value + 1; };
+  ASSERT_EQ(fn(2), 3);
+}
+
+TEST(TargetTests, ReturnsTheHeldCallable) {
+  fu2::function<int(int) const> fn = add_functor{2};
+  ASSERT_NE(fn.target<add_functor>(), nullptr);
+  ASSERT_EQ(fn.target<add_functor>()->offset, 2);
+  ASSERT_EQ(fn.target<large_add_functor>(), nullptr);
+
+  fn.target<add_functor>()->offset = 3;
+  ASSERT_EQ(fn(1), 4);
+
+  fn = large_add_functor{{}, 5};
+  auto const& const_fn = fn;
+  ASSERT_EQ(const_fn.target<add_functor>(), nullptr);
+  ASSERT_EQ(const_fn.target<large_add_functor>()->offset, 5);
+
+  fn = nullptr;
+  ASSERT_EQ(fn.target<large_add_functor>(), nullptr);
+
+  fu2::unique_function<int(int) const> reserved;
+  reserved.reserve(sizeof(large_add_functor));
+  reserved = large_add_functor{{}, 4};
+  ASSERT_EQ(reserved.target<large_add_functor>()->offset, 4);
+
+  // Shared callables are copied before they are returned as mutable
+  fu2::shared_function<int(int) const> shared = large_add_functor{{}, 1};
+  auto copied = shared;
+  auto const& const_shared = shared;
+  ASSERT_EQ(const_shared.target<large_add_functor>(),
+            static_cast<decltype(copied) const&>(copied)
+                .target<large_add_functor>());
+  shared.target<large_add_functor>()->offset = 2;
+  ASSERT_EQ(shared(1), 3);
+  ASSERT_EQ(copied(1), 2);
+
+  fu2::function_base<true, true, fu2::capacity_thin, true, false,
+                     int(int) const>
+      thin = add_functor{7};
+  ASSERT_EQ(thin.target<add_functor>()->offset, 7);
+  ASSERT_EQ(thin.target<large_add_functor>(), nullptr);
+}
+
+TEST(SpeculativeInvocationTests, CallsTheExpectedTypes) {
+  fu2::function<int(int) const> fn = add_functor{1};
+  ASSERT_EQ((fu2::invoke_speculative<large_add_functor, add_functor>(fn, 1)),
+            2);
+
+  fn = [](int value) { return value * 10; };
+  ASSERT_EQ(fu2::invoke_speculative<add_functor>(fn, 2), 20);
+
+  fu2::unique_function<void(int&)> assign = [](int& value) { value = 3; };
+  int value = 0;
+  fu2::invoke_speculative<add_functor>(std::move(assign), value);
+  ASSERT_EQ(value, 3);
+}
+
+TEST(SpeculativeInvocationTests, KeepsTheSignatureQualifiers) {
+  fu2::function<int() const> fn = QualifiedFunctor{};
+  ASSERT_EQ(fu2::invoke_speculative<QualifiedFunctor>(fn), fn());
+  ASSERT_EQ(fu2::invoke_speculative<QualifiedFunctor>(fn), 2);
+
+  fu2::unique_function<int()&&> consumed = QualifiedFunctor{};
+  ASSERT_EQ(fu2::invoke_speculative<QualifiedFunctor>(std::move(consumed)),
+            3);
+
+  // The type check of a const signature never copies a shared callable
+  fu2::shared_function<int(int) const> shared = large_add_functor{{}, 1};
+  auto copied = shared;
+  ASSERT_EQ(fu2::invoke_speculative<large_add_functor>(shared, 1), 2);
+  ASSERT_EQ(static_cast<decltype(shared) const&>(shared)
+                .target<large_add_functor>(),
+            static_cast<decltype(copied) const&>(copied)
+                .target<large_add_functor>());
+
+  // Empty allocators don't take part in the type check
+  fu2::function<int(int) const> allocated;
+  allocated.assign(large_add_functor{{}, 5},
+                   counting_allocator<large_add_functor>{});
+  ASSERT_NE(allocated.target<large_add_functor>(), nullptr);
+  ASSERT_NE((allocated.target<large_add_functor,
+                              counting_allocator<large_add_functor>>()),
+            nullptr);
+  ASSERT_EQ(fu2::invoke_speculative<large_add_functor>(allocated, 1), 6);
+}
+
+#if defined(FU2_HAS_CXX17_AUTO_TEMPLATE_PARAMETER)
+namespace {
+/// Target of the method pointers bound through bind_front
+struct BindTarget {
+  int base;
+
+  int add(int value) const {
+    return base + value;
+  }
+  int add_both(int left, int right) const {
+    return base + left + right;
+  }
+};
+} // namespace
+
+TEST(BindFrontTests, InvokesTheBoundMethod) {
+  BindTarget target{10};
+
+  auto constant = fu2::bind_front<&BindTarget::add>(&target);
+  ASSERT_EQ(sizeof(constant), sizeof(void*));
+
+  allocation_count() = 0;
+  fu2::function<int(int)> fn;
+  fn.assign(constant, counting_allocator<decltype(constant)>{});
+  ASSERT_EQ(fn(5), 15);
+
+  auto with_argument = fu2::bind_front<&BindTarget::add_both>(&target, 2);
+  fn.assign(with_argument, counting_allocator<decltype(with_argument)>{});
+  ASSERT_EQ(fn(3), 15);
+  ASSERT_EQ(allocation_count(), 0U);
+
+  fu2::function<int(int)> by_value =
+      fu2::bind_front<&BindTarget::add_both>(target, 1);
+  target.base = 0;
+  ASSERT_EQ(by_value(2), 13);
+  ASSERT_EQ(fn(3), 5);
+}
+#endif // FU2_HAS_CXX17_AUTO_TEMPLATE_PARAMETER
+
+TEST(BatchInvocationTests, LoopInsideTheThunk) {
+  int const input[] = {1, 2, 3, 4};
+  int output[4] = {};
+
+  fu2::function<fu2::batch<int(int) const>> fn = add_functor{1};
+  ASSERT_EQ(fn(1), 2);
+  fn.invoke_batch(input, 4, output);
+  ASSERT_EQ(output[3], 5);
+
+  fn = large_add_functor{{}, 10};
+  fn.invoke_batch(input, 2, output);
+  ASSERT_EQ(output[0], 11);
+  ASSERT_EQ(output[1], 12);
+
+  int sum = 0;
+  fu2::unique_function<fu2::batch<void(int, int)>> accumulate =
+      [&](int left, int right) { sum += left * right; };
+  std::tuple<int, int> const pairs[] = {std::make_tuple(2, 3),
+                                        std::make_tuple(4, 5)};
+  accumulate.invoke_batch(pairs, 2);
+  ASSERT_EQ(sum, 26);
+
+  fu2::function_view<fu2::batch<int(int) const>> view = fn;
+  view.invoke_batch(input + 2, 2, output);
+  ASSERT_EQ(output[1], 14);
+
+  fu2::function_base<true, true, fu2::capacity_thin, true, false,
+                     fu2::batch<int(int) const>>
+      thin = add_functor{2};
+  thin.invoke_batch(input, 1, output);
+  ASSERT_EQ(output[0], 3);
+
+  fn = nullptr;
+#if !defined(FU2_HAS_DISABLED_EXCEPTIONS)
+  ASSERT_THROW(fn.invoke_batch(input, 4, output), fu2::bad_function_call);
+#endif
+}
+
+TEST(RawFunctionTests, ReturnsACCompatibleThunk) {
+  fu2::function<int(int) const> fn = add_functor{1};
+  fu2::raw_function<int(int) const> raw = fn.raw();
+  ASSERT_EQ(InvokeCCallback(raw.thunk, raw.context, 1), 2);
+  ASSERT_EQ(raw(2), 3);
+
+  fn = large_add_functor{{}, 10};
+  ASSERT_EQ(fn.raw()(1), 11);
+
+  fu2::function_view<int(int) const> view = fn;
+  raw = view.raw();
+  ASSERT_EQ(InvokeCCallback(raw.thunk, raw.context, 2), 12);
+
+  fu2::unique_function<int(int), int(int, int)> overloaded =
+      [](int left, int right = 1) { return left * right; };
+  ASSERT_EQ(overloaded.raw<int(int, int)>()(4, 2), 8);
+
+  fu2::function_base<true, true, fu2::capacity_thin, true, false,
+                     int(int) const>
+      thin = add_functor{3};
+  ASSERT_EQ(thin.raw()(1), 4);
+
+  thin = nullptr;
+#if !defined(FU2_HAS_DISABLED_EXCEPTIONS)
+  ASSERT_THROW(thin.raw()(1), fu2::bad_function_call);
+#endif
+}
+
+TEST(RawFunctionTests, TakesNonTrivialArgumentsLikeTheCallOperator) {
+  using raw_t = fu2::raw_function<std::size_t(std::string) const>;
+  static_assert(std::is_same<decltype(raw_t::thunk),
+                             std::size_t (*)(void*, std::string&&)>::value,
+                "Non trivial arguments are passed as rvalue reference!");
+
+  fu2::function<std::size_t(std::string) const> fn =
+      [](std::string value) { return value.size(); };
+  raw_t raw = fn.raw();
+
+  std::string const text = "fu2";
+  ASSERT_EQ(raw(text), 3U);
+  ASSERT_EQ(text, "fu2");
+  ASSERT_EQ(raw(std::string("function2")), 9U);
+}
+
+TEST(BufferInvocationTests, LoadsThePackedArguments) {
+  using layout_t = fu2::buffer_layout<double(char, double, add_functor const&)>;
+  static_assert(layout_t::size == 1U + sizeof(double) + sizeof(add_functor),
+                "The arguments have to be packed without padding!");
+  static_assert(layout_t::offset(2U) == 1U + sizeof(double),
+                "The arguments have to be packed without padding!");
+
+  // Arguments are loaded from unaligned positions
+  unsigned char buffer[layout_t::size + 1U];
+  layout_t::store(buffer + 1U, 2, 0.5, add_functor{3});
+
+  fu2::function<double(char, double, add_functor const&) const> fn =
+      [](char factor, double value, add_functor const& functor) {
+        return factor * value + functor.offset;
+      };
+  ASSERT_EQ(fn.invoke_from_buffer(buffer + 1U, layout_t::size), 4.0);
+
+  auto count = [](auto&&... args) -> int { return sizeof...(args); };
+  fu2::function_view<int(int), double(char, double, add_functor const&)>
+      view = count;
+  ASSERT_EQ(
+      view.invoke_from_buffer<double(char, double, add_functor const&)>(
+          buffer + 1U, layout_t::size),
+      3.0);
+}
+
+TEST(ComposeTests, FlattensTheStages) {
+  fu2::function<int(int) const> increment = add_functor{1};
+  auto twice = [](int value) { return value * 2; };
+
+  auto inner = fu2::compose(increment, twice);
+  ASSERT_EQ(inner(1), 4);
+
+  auto outer = fu2::compose(inner, add_functor{3}, twice);
+  ASSERT_EQ(std::tuple_size<std::decay_t<decltype(outer.stages())>>::value,
+            4U);
+  ASSERT_EQ(outer(1), 14);
+
+  fu2::unique_function<int(int)> chain = std::move(outer);
+  ASSERT_EQ(chain(0), 10);
+
+  ASSERT_EQ(increment.then(twice)(2), 6);
+  ASSERT_EQ(fu2::function<int(int) const>(add_functor{2})
+                .then(increment)
+                .then(twice)(0),
+            6);
+}
+
+TEST(ComposeTests, AllocatesTheChainOnce) {
+  fu2::function<int(int) const> increment = add_functor{1};
+  fu2::function<int(int) const> twice = [](int value) { return value * 2; };
+
+  allocation_count() = 0;
+  fu2::function<int(int) const> chain;
+  chain.assign(fu2::compose(increment, twice).then(add_functor{3}).then(twice),
+               counting_allocator<int>{});
+  ASSERT_EQ(allocation_count(), 1U);
+  ASSERT_EQ(chain(1), 14);
+
+  // Nesting the functions instead allocates every layer and every copy
+  // of a function which is captured by the next layer
+  allocation_count() = 0;
+  fu2::function<int(int) const> nested;
+  nested.assign([=](int value) { return twice(increment(value)); },
+                counting_allocator<int>{});
+  nested.assign([=](int value) { return twice(nested(value) + 3); },
+                counting_allocator<int>{});
+  ASSERT_EQ(allocation_count(), 3U);
+  ASSERT_EQ(nested(1), 14);
+}
@@ -6,6 +6,14 @@
 
 #include "function2-test.hpp"
 
+// The invocation tables of multi signature functions are constant initialized,
+// their addresses aren't compared since this isn't a constant expression
+// under the undefined behaviour sanitizer.
+static_assert((void(fu2::detail::type_erasure::invocation_table::invoke_table<
+                    void(), void(int)>::get_empty_invocation_table<true>()),
+               true),
+              "");
+
 ALL_LEFT_TYPED_TEST_CASE(MultiSignatureTests)
 
 TYPED_TEST(MultiSignatureTests, CanInvokeMultipleSignatures) {
@@ -26,3 +34,14 @@ TYPED_TEST(MultiSignatureTests, CanInvokeGenericSignatures) {
   EXPECT_TRUE(left(std::true_type{}));
   EXPECT_FALSE(left(std::false_type{}));
 }
+
+TYPED_TEST(MultiSignatureTests, CanReassignMultipleSignatures) {
+  typename TestFixture::template left_multi_t<std::size_t(int),
+                                              std::size_t(int, int) const>
+      left;
+  for (std::size_t i = 0; i < 8; ++i) {
+    left = [i](auto... args) { return i + sizeof...(args); };
+    EXPECT_EQ(left(0), i + 1);
+    EXPECT_EQ(left(0, 0), i + 2);
+  }
+}
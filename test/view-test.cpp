@@ -4,8 +4,26 @@
 //       (See accompanying file LICENSE_1_0.txt or copy at
 //             http://www.boost.org/LICENSE_1_0.txt)
 
+#include <vector>
+
 #include "function2-test.hpp"
 
+namespace {
+int Twice(int value) {
+  return value * 2;
+}
+
+/// Invokes the callback directly or stores it when the store isn't empty
+int CallOrStore(fu2::function_arg<int(int)> callback,
+                std::vector<fu2::unique_function<int(int)>>& store) {
+  if (store.empty()) {
+    return callback(1);
+  }
+  store.push_back(callback.materialize());
+  return 0;
+}
+} // namespace
+
 COPYABLE_LEFT_TYPED_TEST_CASE(AllViewTests)
 
 TYPED_TEST(AllViewTests, CallSucceedsIfNonEmpty) {
@@ -116,3 +134,38 @@ TYPED_TEST(AllViewTests, HasCorrectObjectSize) {
   typename TestFixture::template left_view_t<bool() volatile> view;
   EXPECT_EQ(sizeof(view), 2 * sizeof(void*));
 }
+
+TEST(FunctionArgTests, MaterializesOnDemand) {
+  std::vector<fu2::unique_function<int(int)>> store;
+  auto owned = std::make_unique<int>(2);
+  ASSERT_EQ(CallOrStore([&](int value) { return value + *owned; }, store), 3);
+
+  store.emplace_back(add_functor{0});
+  auto moved = std::make_unique<int>(4);
+  CallOrStore([moved = std::move(moved)](int value) { return value + *moved; },
+              store);
+  ASSERT_EQ(store.back()(1), 5);
+
+  auto copied = add_functor{5};
+  CallOrStore(copied, store);
+  ASSERT_EQ(store.back()(1), 6);
+  ASSERT_EQ(copied(1), 6);
+
+  CallOrStore(&Twice, store);
+  ASSERT_EQ(store.size(), 4U);
+
+  fu2::function_arg<int(int)> arg = copied;
+  fu2::function<int(int)> function = arg.materialize_copyable();
+  ASSERT_EQ(function(2), 7);
+
+  // A move only callable passed as lvalue is referenced but not copied
+  auto unique = [owned = std::make_unique<int>(6)](int value) {
+    return value + *owned;
+  };
+  fu2::function_arg<int(int)> move_only = unique;
+  ASSERT_EQ(move_only(1), 7);
+#if !defined(FU2_HAS_DISABLED_EXCEPTIONS)
+  ASSERT_THROW(move_only.materialize(), fu2::bad_function_call);
+  ASSERT_THROW(move_only.materialize_copyable(), fu2::bad_function_call);
+#endif // FU2_HAS_DISABLED_EXCEPTIONS
+}